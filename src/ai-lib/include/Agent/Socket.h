@@ -18,6 +18,8 @@ namespace ai
       std::vector<Socket *> AcceptMulti(int n);
       bool Connect(std::string hostname, int port);
       bool Listen(int port);
+      /* loopback_only restricts connections to this host */
+      bool Listen(int port, bool loopback_only);
       bool Recv(std::string &msg);
       bool Send(const std::string &msg);
       static bool Select(std::vector<Socket *> &sockets, std::vector<Socket *> &ready, double timeout);
@@ -19,6 +19,8 @@ namespace ai
       virtual Node *Remove();
       virtual bool Empty() const;
       virtual size_t Size() const;
+      virtual size_t MemoryBytes() const;
+      virtual double GetCostBound() const;
     protected:
       std::stack<Node *> frontier;
     private:
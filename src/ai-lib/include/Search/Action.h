@@ -18,6 +18,11 @@ namespace ai
        */
       virtual void   Display() const;
 
+      /* Bytes used by this action, including heap memory it owns.
+       * See State::MemoryBytes.
+       */
+      virtual size_t MemoryBytes() const;
+
     protected:
       /* Data members to support your search problem.
        */
@@ -1,6 +1,10 @@
 #ifndef _SEARCH_ALGORITHM_H_
 #define _SEARCH_ALGORITHM_H_
 
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
 namespace ai
 {
   namespace Search
@@ -36,17 +40,74 @@ namespace ai
        */
       Solution &GetSolution();
 
+      /* Fetch the problem being searched, e.g. to read its statistics.
+       */
+      Problem *GetProblem() const;
+
       /* Fetch internal statistics on storage and runtime usage.
        */
       size_t GetNumberNodesGenerated() const;
       size_t GetMaxNodesStored() const;
+      const Statistics &GetStatistics() const;
 
       /* Set limits to stop run-away searches.
        */
       bool SetGenerationLimit(size_t limit);
       bool SetStoreLimit(size_t limit);
+      /* Stop when nodes, states, actions, frontier and closed list use
+       * this many bytes, 0 for no limit.  See State::MemoryBytes.
+       */
+      bool SetMemoryLimit(size_t bytes);
+
+      /* Write a progress line to os about every interval_seconds while
+       * searching.  A null os turns progress off, the default.
+       */
+      void SetProgress(std::ostream *os, double interval_seconds);
+
+      /* Record every sample_interval'th expansion to sink, which is
+       * not owned.  A null sink turns tracing off, the default.
+       */
+      void SetTrace(TraceSink *sink, unsigned int sample_interval);
+
+      /* Count hardware events into the statistics, see PerfCounters.
+       * Off by default.  The counters are opened by Search, for the
+       * thread that searches.
+       */
+      void SetPerfCounters(bool enable);
+
+      /* Count heap allocations into the statistics, see
+       * AllocationProfile.  Off by default.  Counting is switched on
+       * for the thread that searches while Search runs.
+       */
+      void SetAllocationProfile(bool enable);
 
     protected:
+      /* Progress is considered every PROGRESS_CHECK_NODES generated
+       * nodes, so the clock is not read in the search loop.
+       */
+      static const size_t PROGRESS_CHECK_NODES = 1024;
+      void StartProgress();
+      void CheckProgress(const Node *node, size_t closed_size)
+      {
+        if(progress_os && number_nodes_generated >= progress_next_check)
+          {
+            ReportProgress(node, closed_size);
+          }
+      }
+      void ReportProgress(const Node *node, size_t closed_size);
+
+      void StartTrace();
+      void TraceExpansion(const Node *node, unsigned int children, unsigned int duplicates)
+      {
+        if(trace_sink && trace_expansions++ % trace_interval == 0)
+          {
+            RecordTrace(node, children, duplicates);
+          }
+      }
+      void RecordTrace(const Node *node, unsigned int children, unsigned int duplicates);
+
+      void StartPerfCounters();
+
       /* Search instance specific data.
        */
       Problem  *problem;
@@ -61,11 +122,41 @@ namespace ai
        */
       size_t number_nodes_generated;
       size_t max_nodes_stored;
+      size_t node_bytes;   // nodes, with their states and actions
+      size_t bytes_stored; // node_bytes, frontier and closed list
+      Statistics statistics;
 
       /* Search limits.
        */
       size_t generation_limit;
       size_t store_limit;
+      size_t memory_limit;
+
+      /* Progress reporting.
+       */
+      std::ostream *progress_os;
+      double progress_interval;
+      size_t progress_next_check;
+      size_t progress_last_generated;
+      double best_heuristic; // smallest h generated, for progress
+      std::chrono::steady_clock::time_point progress_start;
+      std::chrono::steady_clock::time_point progress_last;
+
+      /* Tracing.
+       */
+      TraceSink *trace_sink;
+      unsigned int trace_interval;
+      std::uint32_t trace_search;
+      std::uint64_t trace_expansions;
+
+      /* Hardware event counting.
+       */
+      bool perf_enabled;
+      PerfCounters perf_counters;
+
+      /* Heap allocation counting.
+       */
+      bool allocation_enabled;
     private:
     };
   }
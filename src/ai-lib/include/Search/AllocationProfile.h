@@ -0,0 +1,77 @@
+#ifndef _SEARCH_ALLOCATIONPROFILE_H_
+#define _SEARCH_ALLOCATIONPROFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ai
+{
+  namespace Search
+  {
+    /**
+     * Counts heap allocations made through the global operator new and
+     * operator delete, which AllocationProfile.cpp replaces in every
+     * program linked with this library.
+     *
+     * Counting is off until Enable, and is switched per thread, so one
+     * search profiling does not make concurrent ones pay for counting.
+     * When off, the replacements only test the thread's flag before
+     * calling malloc and free.  Counts are kept per thread, so a search
+     * reads those of the thread running it, and are sorted into size
+     * classes by the bytes malloc really reserves.
+     */
+    class AllocationProfile
+    {
+    public:
+      /* Usable sizes up to 16, 32, ... 4096 bytes, then larger.
+       */
+      static const int SIZE_CLASSES = 10;
+
+      struct Counts
+      {
+        std::uint64_t allocations[SIZE_CLASSES];
+        std::uint64_t frees[SIZE_CLASSES];
+        std::uint64_t bytes_allocated;
+        std::uint64_t bytes_freed;
+      };
+
+      /* Switch counting for the calling thread.
+       */
+      static void Enable(bool enable);
+      static bool IsEnabled();
+
+      /* Switches counting for the calling thread while in scope, and
+       * restores the previous setting when destroyed.
+       */
+      class Scope
+      {
+      public:
+        Scope(bool enable);
+        ~Scope();
+      private:
+        Scope(const Scope &);
+        Scope &operator=(const Scope &);
+        bool previous;
+      };
+
+      /* Counts of the calling thread while counting was enabled.
+       */
+      static void Read(Counts &counts);
+
+      /* end - start, per size class and in total.
+       */
+      static void Subtract(const Counts &end, const Counts &start, Counts &difference);
+      static std::uint64_t TotalAllocations(const Counts &counts);
+      static std::uint64_t TotalFrees(const Counts &counts);
+
+      /* Largest usable size in the class, 0 for the last, unbounded class.
+       */
+      static size_t SizeClassLimit(int size_class);
+    };
+  }
+}
+
+#endif /* _SEARCH_ALLOCATIONPROFILE_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
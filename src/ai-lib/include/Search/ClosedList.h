@@ -35,6 +35,8 @@ namespace ai
       bool Contains(const Node * const node_in) const;
       bool Insert(Node * node_in);
       size_t Size() const;
+      /* Bytes used by the list's own storage, not the nodes. */
+      size_t MemoryBytes() const;
 
     protected:
       void SetStyle(const Node * const node_in);
@@ -19,6 +19,7 @@ namespace ai
       virtual Node *Remove();
       virtual bool Empty() const;
       virtual size_t Size() const;
+      virtual size_t MemoryBytes() const;
     protected:
       std::stack<Node *> frontier;
     private:
@@ -0,0 +1,85 @@
+#ifndef _SEARCH_ESTIMATOR_H_
+#define _SEARCH_ESTIMATOR_H_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace ai
+{
+  namespace Search
+  {
+    /**
+     * Predicts the size of a cost bounded tree search before running
+     * it, with Knuth's estimator.
+     *
+     * A probe walks from the initial state, at each node counting the
+     * children whose f = g + h is within the threshold, and following
+     * one of them at random.  The products of the counts along the walk
+     * are an unbiased estimate of the nodes in the bounded tree.  Probes
+     * are averaged.  A graph search stores each state once, so for it
+     * the tree count is an overestimate, by the duplicate paths.
+     */
+    class Estimator
+    {
+    public:
+      /* problem_in is not owned.  The probes draw from their own
+       * generator, seeded with seed, so a caller seeds it from its own
+       * random stream to keep runs reproducible.
+       */
+      Estimator(Problem *problem_in, std::uint64_t seed);
+
+      /* Estimated nodes with f <= threshold, from up to probes probes.
+       * Probing stops early at deadline, after at least one probe.
+       */
+      double EstimateNodes(double threshold, unsigned int probes,
+                           std::chrono::steady_clock::time_point deadline);
+
+      /* Walks from the initial state to the child with the smallest
+       * heuristic, ties broken at random, until a goal, a dead end or a
+       * path cost over bound.  A goal lowers GetGoalCost.
+       */
+      void GreedyProbe(double bound);
+
+      /* Probes run by the last EstimateNodes.
+       */
+      unsigned int GetProbeCount() const;
+
+      /* Smallest path cost of a goal met by any probe so far, infinite
+       * if none was met.  An upper bound on the optimal cost.
+       */
+      double GetGoalCost() const;
+
+      /* Nodes generated by all probes, and the seconds they took, to
+       * estimate the speed of a search.
+       */
+      std::uint64_t GetNodesGenerated() const;
+      double GetSeconds() const;
+
+      /* Bytes a Graph search stores for each node, as counted against
+       * its memory limit, measured on a child of the initial state.
+       */
+      size_t NodeBytes();
+
+    protected:
+      /* Walks to a leaf, or to the maximum depth.
+       */
+      static const unsigned int MAX_PROBE_DEPTH = 256;
+      double Probe(double threshold);
+
+      Problem *problem;
+      /* ai-lib has no generator of its own, see the constructor */
+      std::mt19937_64 random;
+      unsigned int probe_count;
+      double goal_cost;
+      std::uint64_t nodes_generated;
+      double seconds;
+    private:
+    };
+  }
+}
+
+#endif /* _SEARCH_ESTIMATOR_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
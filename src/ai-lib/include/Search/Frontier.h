@@ -25,6 +25,17 @@ namespace ai
       virtual Node *Remove() = 0;
       virtual bool Empty() const = 0;
       virtual size_t Size() const = 0;
+
+      /* Largest path cost + heuristic this frontier will accept.
+       * Defaults to infinity.  Bounded frontiers override this so
+       * the search can tell the heuristic when to stop early.
+       */
+      virtual double GetCostBound() const;
+
+      /* Bytes used by the frontier's own storage, not the nodes.
+       * Defaults to one pointer per node.
+       */
+      virtual size_t MemoryBytes() const;
     protected:
     private:
     };
@@ -0,0 +1,63 @@
+#ifndef _SEARCH_MEMORY_H_
+#define _SEARCH_MEMORY_H_
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace ai
+{
+  namespace Search
+  {
+    /* Bytes a heap allocation of n bytes really occupies, with the
+     * allocator's header and rounding.  Modeled on 64 bit glibc malloc:
+     * an 8 byte header, 16 byte alignment and a 32 byte minimum.
+     */
+    size_t HeapBlockBytes(size_t n);
+
+    /* Heap bytes owned by s, 0 when it fits in the string object. */
+    size_t StringHeapBytes(const std::string &s);
+
+    /* Heap bytes owned by v. */
+    template <class T>
+    size_t VectorHeapBytes(const std::vector<T> &v)
+    {
+      return v.capacity() == 0 ? 0 : HeapBlockBytes(v.capacity() * sizeof(T));
+    }
+
+    /* Heap bytes of a deque of size elements of element_bytes each.
+     * Modeled on libstdc++: 512 byte chunks, a chunk past the last
+     * element, and a map of chunk pointers of at least 8 entries.
+     */
+    size_t DequeBlockBytes(size_t size, size_t element_bytes);
+
+    /* Heap bytes owned by d. */
+    template <class T>
+    size_t DequeHeapBytes(const std::deque<T> &d)
+    {
+      return DequeBlockBytes(d.size(), sizeof(T));
+    }
+
+    /* The container under a std::stack, std::queue or
+     * std::priority_queue, which keeps it protected.
+     */
+    template <class Adaptor>
+    const typename Adaptor::container_type &AdaptorContainer(const Adaptor &a)
+    {
+      struct Access : Adaptor
+      {
+        static const typename Adaptor::container_type &Get(const Adaptor &a)
+        {
+          return a.*&Access::c;
+        }
+      };
+      return Access::Get(a);
+    }
+  }
+}
+
+#endif /* _SEARCH_MEMORY_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
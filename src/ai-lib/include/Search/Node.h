@@ -33,6 +33,12 @@ namespace ai
       bool    RemoveParent( );
       size_t  GetChildCount() const;
 
+      /* Bytes used by this node, its state and its action.  Each child
+       * link adds CHILD_LINK_BYTES to its parent.
+       */
+      size_t  MemoryBytes() const;
+      static const size_t CHILD_LINK_BYTES;
+
     protected:
 
       State  *state;
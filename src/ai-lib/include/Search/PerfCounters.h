@@ -0,0 +1,75 @@
+#ifndef _SEARCH_PERFCOUNTERS_H_
+#define _SEARCH_PERFCOUNTERS_H_
+
+#include <cstdint>
+#include <string>
+
+namespace ai
+{
+  namespace Search
+  {
+    /**
+     * Hardware event counters of the calling thread, from Linux
+     * perf_event_open.
+     *
+     * The events are opened as one group, so they are counted over the
+     * same instructions, and read together with one system call.  Only
+     * user space is counted, which unprivileged processes may do at
+     * perf_event_paranoid 2.  Events the processor, kernel or container
+     * does not provide are left out; when none can be opened, GetError
+     * tells why and Read returns zeros.
+     */
+    class PerfCounters
+    {
+    public:
+      enum EventType
+        {
+          E_CYCLES,
+          E_INSTRUCTIONS,
+          E_L1D_MISSES,    // level 1 data cache read misses
+          E_LLC_MISSES,    // last level cache misses
+          E_BRANCH_MISSES,
+          E_MAX
+        };
+
+      PerfCounters();
+      /* Closes the counters.
+       */
+      ~PerfCounters();
+
+      /* Starts counting for the calling thread.  Returns whether any
+       * event could be opened.
+       */
+      bool Open();
+      void Close();
+      bool IsOpen() const;
+      bool IsAvailable(EventType event) const;
+
+      /* Why no event could be opened, "" if one was.
+       */
+      const std::string &GetError() const;
+
+      /* Event counts since Open, scaled up if the kernel multiplexed the
+       * counters.  0 for events not available.
+       */
+      void Read(std::uint64_t values[E_MAX]) const;
+
+      static const char *EventName(EventType event);
+
+    protected:
+      int leader_fd;
+      int fds[E_MAX];
+      int read_index[E_MAX]; // position of each event in a group read, -1 if not open
+      int open_count;
+      std::string error;
+    private:
+      PerfCounters(const PerfCounters &);
+      PerfCounters &operator=(const PerfCounters &);
+    };
+  }
+}
+
+#endif /* _SEARCH_PERFCOUNTERS_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
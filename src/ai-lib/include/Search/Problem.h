@@ -60,6 +60,13 @@ namespace ai
        */
       virtual double Heuristic(const State  * const state_in) const;
 
+      /* Same as Heuristic(), but the search promises to discard
+       * state_in if the estimate exceeds bound_in.  Once the
+       * estimate is known to exceed bound_in, any value larger
+       * than bound_in may be returned.  Defaults to Heuristic().
+       */
+      virtual double BoundedHeuristic(const State  * const state_in, double bound_in) const;
+
     protected:
       /* Set from the constructor, and deleted from destructor, as documented above.
        */
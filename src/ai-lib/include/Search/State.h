@@ -1,5 +1,6 @@
 #ifndef _SEARCH_STATE_H_
 #define _SEARCH_STATE_H_
+#include <cstdint>
 #include <string>
 
 namespace ai
@@ -33,6 +34,18 @@ namespace ai
        */
       virtual bool IsLessThan(const State * const state_in) const = 0;
 
+      /* Bytes used by this state, including heap memory it owns, for
+       * memory limits.  Override to count the derived object and its
+       * members; the default counts only a State allocation.
+       */
+      virtual size_t MemoryBytes() const;
+
+      /* A hash of the state value, used to identify states in search
+       * traces.  Equal states must have equal fingerprints.  The
+       * default is 0, which makes every state look alike.
+       */
+      virtual std::uint64_t Fingerprint() const;
+
     protected:
       /* Choose data values appropriate for your problem.
        */
@@ -0,0 +1,199 @@
+#ifndef _SEARCH_STATISTICS_H_
+#define _SEARCH_STATISTICS_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace ai
+{
+  namespace Search
+  {
+    /**
+     * Counters and timers for one search, kept by Algorithm.
+     *
+     * Counters are exact.  Timers time only every SAMPLE_INTERVAL'th
+     * call of each kind, and scale the sampled time by the number of
+     * calls, so the clock is read rarely in the search loop.
+     *
+     * With PerfCounters, sampled timers also count hardware events, and
+     * the events of the whole search are kept.  With AllocationProfile
+     * enabled, the search's heap allocations are kept.
+     */
+    class Statistics
+    {
+    public:
+      enum CounterType
+        {
+          C_EXPANSIONS,            // nodes whose actions were generated
+          C_GOAL_TESTS,
+          C_HEURISTIC_CALLS,
+          C_CLOSED_HITS_ON_POP,    // removed from the frontier, state already closed
+          C_CLOSED_HITS_ON_GENERATION, // generated state already closed
+          C_FRONTIER_REJECTIONS,   // frontier refused an insert, e.g. depth limit
+          C_MAX
+        };
+
+      enum TimerType
+        {
+          T_EXPANSION,   // Actions, Result and StepCost
+          T_HEURISTIC,
+          T_CLOSED_LIST, // Contains and Insert
+          T_FRONTIER,    // Insert and Remove
+          T_MAX
+        };
+
+      /* must be a power of 2 */
+      static const std::uint64_t SAMPLE_INTERVAL = 16;
+
+      /**
+       * Times the enclosing scope, if this call of its kind is sampled.
+       */
+      class ScopedTimer
+      {
+      public:
+        ScopedTimer(Statistics &statistics_in, TimerType timer_in)
+          : statistics(statistics_in), timer(timer_in),
+            sampled((statistics_in.timer_calls[timer_in]++ & (SAMPLE_INTERVAL - 1)) == 0)
+        {
+          if(sampled)
+            {
+              if(statistics.perf_counters)
+                {
+                  statistics.perf_counters->Read(events_start);
+                }
+              start = std::chrono::steady_clock::now();
+            }
+        }
+        ~ScopedTimer()
+        {
+          if(sampled)
+            {
+              statistics.timer_samples[timer]++;
+              statistics.timer_sampled_ns[timer] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+              if(statistics.perf_counters)
+                {
+                  statistics.AddTimerEvents(timer, events_start);
+                }
+            }
+        }
+      protected:
+        Statistics &statistics;
+        TimerType timer;
+        bool sampled;
+        std::chrono::steady_clock::time_point start;
+        std::uint64_t events_start[PerfCounters::E_MAX];
+      private:
+      };
+
+      Statistics();
+      /* Also stops counting events.
+       */
+      void Clear();
+
+      /* Sums counters and timers, and keeps the larger peaks.  Used to
+       * combine the iterations of iterative deepening.
+       */
+      void Add(const Statistics &rhs);
+
+      void Count(CounterType counter)
+      {
+        counters[counter]++;
+      }
+      void UpdatePeakFrontier(size_t size)
+      {
+        if(size > peak_frontier)
+          {
+            peak_frontier = size;
+          }
+      }
+      void UpdatePeakClosed(size_t size)
+      {
+        if(size > peak_closed)
+          {
+            peak_closed = size;
+          }
+      }
+      void UpdatePeakBytes(size_t bytes)
+      {
+        if(bytes > peak_bytes)
+          {
+            peak_bytes = bytes;
+          }
+      }
+
+      /* Counts events from counters, which is not owned and must stay
+       * open until UpdateEvents.  If counters could not be opened, its
+       * error is kept for Display.
+       */
+      void StartEvents(const PerfCounters &counters);
+      /* Sets the search's events to those since StartEvents.
+       */
+      void UpdateEvents();
+
+      /* Counts the calling thread's allocations from now, if
+       * AllocationProfile is enabled.
+       */
+      void StartAllocations();
+      /* Sets the search's allocations to those since StartAllocations.
+       */
+      void UpdateAllocations();
+
+      std::uint64_t GetCounter(CounterType counter) const;
+      size_t GetPeakFrontier() const;
+      size_t GetPeakClosed() const;
+      /* most bytes used by nodes, states, actions, frontier and closed list */
+      size_t GetPeakBytes() const;
+      /* number of timed calls, and estimated total seconds in them */
+      std::uint64_t GetTimerCalls(TimerType timer) const;
+      double GetTimerSeconds(TimerType timer) const;
+      /* whether events were counted, and the counts of the whole search
+       * and, estimated from the sampled calls, of each timer
+       */
+      bool GetEventAvailable(PerfCounters::EventType event) const;
+      std::uint64_t GetEvents(PerfCounters::EventType event) const;
+      double GetTimerEvents(TimerType timer, PerfCounters::EventType event) const;
+      /* whether allocations were counted, and the counts */
+      bool GetAllocationsCounted() const;
+      const AllocationProfile::Counts &GetAllocations() const;
+
+      static const char *CounterName(CounterType counter);
+      static const char *TimerName(TimerType timer);
+
+      /* One item per line, for people. */
+      void Display(std::ostream &os) const;
+      /* name value pairs on one line, for programs. */
+      void DisplayFields(std::ostream &os) const;
+
+    protected:
+      std::uint64_t counters[C_MAX];
+      size_t peak_frontier;
+      size_t peak_closed;
+      size_t peak_bytes;
+      std::uint64_t timer_calls[T_MAX];
+      std::uint64_t timer_samples[T_MAX];
+      std::uint64_t timer_sampled_ns[T_MAX];
+
+      void AddTimerEvents(TimerType timer, const std::uint64_t start[PerfCounters::E_MAX]);
+      const PerfCounters *perf_counters; // null when not counting
+      bool events_requested;
+      bool events_available[PerfCounters::E_MAX];
+      std::string events_error;
+      std::uint64_t events_start[PerfCounters::E_MAX];
+      std::uint64_t events[PerfCounters::E_MAX];
+      std::uint64_t timer_events[T_MAX][PerfCounters::E_MAX]; // sampled calls only
+
+      bool allocations_counted;
+      AllocationProfile::Counts allocations_start;
+      AllocationProfile::Counts allocations;
+    private:
+    };
+  }
+}
+
+#endif /* _SEARCH_STATISTICS_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
@@ -0,0 +1,113 @@
+#ifndef _SEARCH_TRACE_H_
+#define _SEARCH_TRACE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace ai
+{
+  namespace Search
+  {
+    /**
+     * One expanded node, as recorded by a traced search.
+     */
+    struct TraceRecord
+    {
+      std::uint32_t search;      // from TraceSink::BeginSearch
+      std::uint32_t depth;
+      std::uint64_t expansion;   // expansions before this one in the search
+      std::uint64_t fingerprint; // State::Fingerprint of the node
+      std::uint64_t parent;      // fingerprint of the parent, 0 for the root
+      double        g;           // path cost
+      double        h;           // heuristic
+      std::uint32_t children;    // nodes added to the frontier
+      std::uint32_t duplicates;  // generated states already closed
+    };
+
+    /**
+     * Receives the expansions of traced searches.  See
+     * Algorithm::SetTrace.  Record may be called from several threads.
+     */
+    class TraceSink
+    {
+    public:
+      TraceSink();
+      virtual ~TraceSink();
+      /* a new search identifier */
+      std::uint32_t BeginSearch();
+      virtual void Record(const TraceRecord &record) = 0;
+    protected:
+      std::atomic<std::uint32_t> next_search;
+    private:
+    };
+
+    /**
+     * Writes a trace file: an 8 byte magic, a version and the record
+     * size, then fixed size records in host byte order.
+     *
+     * Records are collected in a buffer.  A full buffer is handed to a
+     * writer thread and the search continues in a second buffer, so
+     * the search only waits when the disk falls two buffers behind.
+     */
+    class TraceFileWriter : public TraceSink
+    {
+    public:
+      static const char MAGIC[8];
+      static const std::uint32_t VERSION = 1;
+      static const size_t BUFFER_RECORDS = 8192;
+
+      TraceFileWriter();
+      virtual ~TraceFileWriter();
+      /* false if the file can not be created */
+      bool Open(const std::string &filename);
+      /* writes the remaining records and closes the file */
+      void Close();
+      bool IsOpen() const;
+      const std::string &GetFilename() const;
+      std::uint64_t GetRecordCount() const;
+
+      virtual void Record(const TraceRecord &record);
+
+    protected:
+      void WriterThread();
+      void HandOff(std::unique_lock<std::mutex> &lock);
+
+      std::string filename;
+      std::ofstream fout;
+      std::vector<TraceRecord> filling;  // being filled by searches
+      std::vector<TraceRecord> writing;  // being written by the thread
+      bool writing_full;
+      bool stopping;
+      std::uint64_t record_count;
+      std::mutex mutex;
+      std::condition_variable changed;
+      std::thread writer;
+    private:
+    };
+
+    /**
+     * Reads a trace file written by TraceFileWriter.
+     */
+    class TraceFileReader
+    {
+    public:
+      /* false if the file is missing or not a trace */
+      bool Open(const std::string &filename);
+      bool Next(TraceRecord &record);
+    protected:
+      std::ifstream fin;
+    private:
+    };
+  }
+}
+
+#endif /* _SEARCH_TRACE_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
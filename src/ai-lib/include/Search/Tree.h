@@ -25,6 +25,8 @@ namespace ai
        * {
        *   // get solution
        * }
+       *
+       * Allocations are counted, if enabled, during each call.
        */
       virtual bool SearchInit();
       virtual bool SearchNext();
@@ -1,6 +1,7 @@
 #ifndef _AI_SEARCH_H_
 #define _AI_SEARCH_H_
 
+#include <Search/Memory.h>
 #include <Search/Action.h>
 #include <Search/State.h>
 #include <Search/ActionStatePair.h>
@@ -16,9 +17,14 @@
 #include <Search/GreedyFrontier.h>
 #include <Search/AStarFrontier.h>
 #include <Search/Solution.h>
+#include <Search/PerfCounters.h>
+#include <Search/AllocationProfile.h>
+#include <Search/Statistics.h>
+#include <Search/Trace.h>
 #include <Search/Algorithm.h>
 #include <Search/Tree.h>
 #include <Search/ClosedList.h>
 #include <Search/Graph.h>
+#include <Search/Estimator.h>
 
 #endif /* _AI_SEARCH_H_ */
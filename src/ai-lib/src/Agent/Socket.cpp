@@ -97,6 +97,10 @@ namespace ai
       return true;
     }
     bool Socket::Listen(int port)
+    {
+      return Listen(port, false);
+    }
+    bool Socket::Listen(int port, bool loopback_only)
     {
       if((mSocket = socket(PF_INET, SOCK_STREAM, 0)) == -1)
         {
@@ -112,7 +116,7 @@ namespace ai
       sockaddr_in local_addr;
       local_addr.sin_family = AF_INET;
       local_addr.sin_port = htons(port);
-      local_addr.sin_addr.s_addr = INADDR_ANY;
+      local_addr.sin_addr.s_addr = htonl(loopback_only ? INADDR_LOOPBACK : INADDR_ANY);
       memset(local_addr.sin_zero, '\0', sizeof(local_addr.sin_zero));
       if(bind(mSocket, (sockaddr *)&local_addr, sizeof(local_addr)) == -1)
         {
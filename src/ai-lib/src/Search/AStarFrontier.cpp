@@ -32,6 +32,11 @@ namespace ai
       return frontier.size();
     }
 
+    size_t AStarFrontier::MemoryBytes() const
+    {
+      return VectorHeapBytes(AdaptorContainer(frontier));
+    }
+
     AStarFrontier::NodePtr::NodePtr(Node *node_in)
     {
       ptr = node_in;
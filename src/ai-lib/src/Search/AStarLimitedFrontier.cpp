@@ -40,6 +40,16 @@ namespace ai
     {
       return frontier.size();
     }
+
+    size_t AStarLimitedFrontier::MemoryBytes() const
+    {
+      return DequeHeapBytes(AdaptorContainer(frontier));
+    }
+
+    double AStarLimitedFrontier::GetCostBound() const
+    {
+      return max_cost;
+    }
   }
 }
 
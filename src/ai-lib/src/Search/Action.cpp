@@ -17,5 +17,10 @@ namespace ai
       std::cout << "Action Display. Override me if you want better information." << std::endl;
     }
 
+    size_t Action::MemoryBytes() const
+    {
+      return HeapBlockBytes(sizeof(Action));
+    }
+
   }
 }
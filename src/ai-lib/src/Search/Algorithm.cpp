@@ -1,4 +1,8 @@
 #include "ai_search.h"
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <unistd.h>
 
 namespace ai
 {
@@ -14,6 +18,23 @@ namespace ai
       max_nodes_stored       = 0;
       generation_limit       = 0;
       store_limit            = 0;
+      memory_limit           = 0;
+      node_bytes             = 0;
+      bytes_stored           = 0;
+
+      progress_os             = 0;
+      progress_interval       = 0.0;
+      progress_next_check     = 0;
+      progress_last_generated = 0;
+      best_heuristic          = std::numeric_limits<double>::infinity();
+
+      trace_sink       = 0;
+      trace_interval   = 1;
+      trace_search     = 0;
+      trace_expansions = 0;
+
+      perf_enabled = false;
+      allocation_enabled = false;
     }
 
     Algorithm::~Algorithm()
@@ -41,6 +62,11 @@ namespace ai
       return solution;
     }
 
+    Problem *Algorithm::GetProblem() const
+    {
+      return problem;
+    }
+
     size_t Algorithm::GetNumberNodesGenerated() const
     {
       return number_nodes_generated;
@@ -51,6 +77,11 @@ namespace ai
       return max_nodes_stored;
     }
 
+    const Statistics &Algorithm::GetStatistics() const
+    {
+      return statistics;
+    }
+
     bool Algorithm::SetGenerationLimit(size_t limit)
     {
       generation_limit = limit;
@@ -63,5 +94,124 @@ namespace ai
       return true;
     }
 
+    bool Algorithm::SetMemoryLimit(size_t bytes)
+    {
+      memory_limit = bytes;
+      return true;
+    }
+
+    void Algorithm::SetProgress(std::ostream *os, double interval_seconds)
+    {
+      progress_os       = os;
+      progress_interval = interval_seconds;
+    }
+
+    void Algorithm::SetTrace(TraceSink *sink, unsigned int sample_interval)
+    {
+      trace_sink     = sink;
+      trace_interval = sample_interval > 0 ? sample_interval : 1;
+    }
+
+    void Algorithm::SetPerfCounters(bool enable)
+    {
+      perf_enabled = enable;
+    }
+
+    void Algorithm::SetAllocationProfile(bool enable)
+    {
+      allocation_enabled = enable;
+    }
+
+    void Algorithm::StartProgress()
+    {
+      progress_next_check     = PROGRESS_CHECK_NODES;
+      progress_last_generated = 0;
+      best_heuristic          = std::numeric_limits<double>::infinity();
+      if(progress_os)
+        {
+          progress_start = progress_last = std::chrono::steady_clock::now();
+        }
+    }
+
+    /* resident set size in bytes, 0 where /proc is not available */
+    static size_t resident_bytes()
+    {
+      std::ifstream fin("/proc/self/statm");
+      size_t total_pages = 0, resident_pages = 0;
+      if(!(fin >> total_pages >> resident_pages))
+        {
+          return 0;
+        }
+      return resident_pages * sysconf(_SC_PAGESIZE);
+    }
+
+    void Algorithm::ReportProgress(const Node *node, size_t closed_size)
+    {
+      progress_next_check = number_nodes_generated + PROGRESS_CHECK_NODES;
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      std::chrono::duration<double> since_last = now - progress_last;
+      if(since_last.count() < progress_interval)
+        {
+          return;
+        }
+      std::chrono::duration<double> elapsed = now - progress_start;
+
+      /* one write per line, so concurrent searches do not interleave */
+      std::stringstream line;
+      line << "progress"
+           << " elapsed " << elapsed.count()
+           << " generated " << number_nodes_generated
+           << " nodes_per_second " << static_cast<size_t>((number_nodes_generated - progress_last_generated) / since_last.count())
+           << " frontier " << frontier->Size()
+           << " closed " << closed_size
+           << " f " << node->GetPathCost() + node->GetHeuristic()
+           << " depth " << node->GetDepth()
+           << " best_h " << best_heuristic
+           << " memory_mb " << bytes_stored / (1024 * 1024)
+           << " rss_mb " << resident_bytes() / (1024 * 1024)
+           << std::endl;
+      *progress_os << line.str() << std::flush;
+
+      progress_last           = now;
+      progress_last_generated = number_nodes_generated;
+    }
+
+    void Algorithm::StartTrace()
+    {
+      trace_expansions = 0;
+      if(trace_sink)
+        {
+          trace_search = trace_sink->BeginSearch();
+        }
+    }
+
+    void Algorithm::StartPerfCounters()
+    {
+      if(!perf_enabled)
+        {
+          return;
+        }
+      if(!perf_counters.IsOpen())
+        {
+          perf_counters.Open();
+        }
+      statistics.StartEvents(perf_counters);
+    }
+
+    void Algorithm::RecordTrace(const Node *node, unsigned int children, unsigned int duplicates)
+    {
+      TraceRecord record;
+      record.search      = trace_search;
+      record.depth       = node->GetDepth();
+      record.expansion   = trace_expansions - 1;
+      record.fingerprint = node->GetState()->Fingerprint();
+      record.parent      = node->GetParent() ? node->GetParent()->GetState()->Fingerprint() : 0;
+      record.g           = node->GetPathCost();
+      record.h           = node->GetHeuristic();
+      record.children    = children;
+      record.duplicates  = duplicates;
+      trace_sink->Record(record);
+    }
+
   }
 }
@@ -0,0 +1,202 @@
+#include "ai_search.h"
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+namespace ai
+{
+  namespace Search
+  {
+    /* zero initialized, so reading them from operator new needs no constructor */
+    static thread_local bool profiling;
+    static thread_local AllocationProfile::Counts thread_counts;
+
+    static int size_class(size_t usable)
+    {
+      int c = 0;
+      size_t limit = 16;
+      while(c < AllocationProfile::SIZE_CLASSES - 1 && usable > limit)
+        {
+          c++;
+          limit *= 2;
+        }
+      return c;
+    }
+
+    static void count_allocation(void *p)
+    {
+      size_t usable = malloc_usable_size(p);
+      thread_counts.allocations[size_class(usable)]++;
+      thread_counts.bytes_allocated += usable;
+    }
+
+    static void count_free(void *p)
+    {
+      size_t usable = malloc_usable_size(p);
+      thread_counts.frees[size_class(usable)]++;
+      thread_counts.bytes_freed += usable;
+    }
+
+    static void *profiled_allocate(size_t n)
+    {
+      if(n == 0)
+        {
+          n = 1;
+        }
+      void *p;
+      while((p = std::malloc(n)) == 0)
+        {
+          std::new_handler handler = std::get_new_handler();
+          if(!handler)
+            {
+              throw std::bad_alloc();
+            }
+          handler();
+        }
+      if(profiling)
+        {
+          count_allocation(p);
+        }
+      return p;
+    }
+
+    static void *profiled_allocate_nothrow(size_t n) noexcept
+    {
+      try
+        {
+          return profiled_allocate(n);
+        }
+      catch(const std::bad_alloc &)
+        {
+          return 0;
+        }
+    }
+
+    static void profiled_free(void *p)
+    {
+      if(p && profiling)
+        {
+          count_free(p);
+        }
+      std::free(p);
+    }
+
+    void AllocationProfile::Enable(bool enable)
+    {
+      profiling = enable;
+    }
+
+    bool AllocationProfile::IsEnabled()
+    {
+      return profiling;
+    }
+
+    AllocationProfile::Scope::Scope(bool enable)
+      : previous(profiling)
+    {
+      profiling = enable;
+    }
+
+    AllocationProfile::Scope::~Scope()
+    {
+      profiling = previous;
+    }
+
+    void AllocationProfile::Read(Counts &counts)
+    {
+      counts = thread_counts;
+    }
+
+    void AllocationProfile::Subtract(const Counts &end, const Counts &start, Counts &difference)
+    {
+      int c;
+      for(c = 0; c < SIZE_CLASSES; c++)
+        {
+          difference.allocations[c] = end.allocations[c] - start.allocations[c];
+          difference.frees[c]       = end.frees[c] - start.frees[c];
+        }
+      difference.bytes_allocated = end.bytes_allocated - start.bytes_allocated;
+      difference.bytes_freed     = end.bytes_freed - start.bytes_freed;
+    }
+
+    std::uint64_t AllocationProfile::TotalAllocations(const Counts &counts)
+    {
+      std::uint64_t total = 0;
+      int c;
+      for(c = 0; c < SIZE_CLASSES; c++)
+        {
+          total += counts.allocations[c];
+        }
+      return total;
+    }
+
+    std::uint64_t AllocationProfile::TotalFrees(const Counts &counts)
+    {
+      std::uint64_t total = 0;
+      int c;
+      for(c = 0; c < SIZE_CLASSES; c++)
+        {
+          total += counts.frees[c];
+        }
+      return total;
+    }
+
+    size_t AllocationProfile::SizeClassLimit(int size_class)
+    {
+      return size_class < SIZE_CLASSES - 1 ? static_cast<size_t>(16) << size_class : 0;
+    }
+  }
+}
+
+/* The replaceable global allocation functions.  The aligned forms are
+ * left to the standard library, which nothing here uses.
+ */
+void *operator new(std::size_t n)
+{
+  return ai::Search::profiled_allocate(n);
+}
+
+void *operator new[](std::size_t n)
+{
+  return ai::Search::profiled_allocate(n);
+}
+
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept
+{
+  return ai::Search::profiled_allocate_nothrow(n);
+}
+
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept
+{
+  return ai::Search::profiled_allocate_nothrow(n);
+}
+
+void operator delete(void *p) noexcept
+{
+  ai::Search::profiled_free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  ai::Search::profiled_free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+  ai::Search::profiled_free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+  ai::Search::profiled_free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+  ai::Search::profiled_free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+  ai::Search::profiled_free(p);
+}
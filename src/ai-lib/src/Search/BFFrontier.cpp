@@ -32,5 +32,10 @@ namespace ai
       return frontier.size();
     }
 
+    size_t BFFrontier::MemoryBytes() const
+    {
+      return DequeHeapBytes(AdaptorContainer(frontier));
+    }
+
   }
 }
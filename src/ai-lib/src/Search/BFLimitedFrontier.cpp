@@ -41,5 +41,10 @@ namespace ai
       return frontier.size();
     }
 
+    size_t BFLimitedFrontier::MemoryBytes() const
+    {
+      return DequeHeapBytes(AdaptorContainer(frontier));
+    }
+
   }
 }
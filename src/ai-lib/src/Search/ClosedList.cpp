@@ -92,6 +92,13 @@ namespace ai
       return 0;
     }
 
+    size_t ClosedList::MemoryBytes() const
+    {
+      /* a red-black tree node: color padded to a pointer, three links and the value */
+      static const size_t set_node_bytes = HeapBlockBytes(4 * sizeof(void *) + sizeof(ClosedListStatePointer));
+      return VectorHeapBytes(closed_list) + closed_set.size() * set_node_bytes;
+    }
+
     void ClosedList::SetStyle(const Node * const /* node_in */)
     {
       if(use_set == US_UNKNOWN)
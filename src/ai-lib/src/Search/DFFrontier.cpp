@@ -30,5 +30,10 @@ namespace ai
     {
       return frontier.size();
     }
+
+    size_t DFFrontier::MemoryBytes() const
+    {
+      return DequeHeapBytes(AdaptorContainer(frontier));
+    }
   }
 }
@@ -40,6 +40,11 @@ namespace ai
     {
       return frontier.size();
     }
+
+    size_t DLFrontier::MemoryBytes() const
+    {
+      return DequeHeapBytes(AdaptorContainer(frontier));
+    }
   }
 }
 
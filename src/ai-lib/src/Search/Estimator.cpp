@@ -0,0 +1,218 @@
+#include "ai_search.h"
+#include <limits>
+
+namespace ai
+{
+  namespace Search
+  {
+    Estimator::Estimator(Problem *problem_in, std::uint64_t seed)
+      : problem(problem_in), random(seed), probe_count(0),
+        goal_cost(std::numeric_limits<double>::infinity()),
+        nodes_generated(0), seconds(0.0)
+    {
+    }
+
+    double Estimator::EstimateNodes(double threshold, unsigned int probes,
+                                    std::chrono::steady_clock::time_point deadline)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      double total = 0.0;
+      probe_count = 0;
+      while(probe_count < probes &&
+            (probe_count == 0 || std::chrono::steady_clock::now() < deadline))
+        {
+          total += Probe(threshold);
+          probe_count++;
+        }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      seconds += elapsed.count();
+      return total / probe_count;
+    }
+
+    void Estimator::GreedyProbe(double bound)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      State *state = problem->GetInitialState();
+      double g = 0.0;
+      unsigned int depth;
+      for(depth = 0; depth < MAX_PROBE_DEPTH; depth++)
+        {
+          if(problem->GoalTest(state))
+            {
+              if(g < goal_cost)
+                {
+                  goal_cost = g;
+                }
+              break;
+            }
+          State *best = 0;
+          double best_g = 0.0, best_h = 0.0;
+          unsigned int ties = 0;
+          std::vector<Action *> actions = problem->Actions(state);
+          std::vector<Action *>::iterator aiter;
+          for(aiter = actions.begin(); aiter != actions.end(); aiter++)
+            {
+              State *child = problem->Result(state, *aiter);
+              double child_g = g + problem->StepCost(state, *aiter, child);
+              double child_h = problem->Heuristic(child);
+              nodes_generated++;
+              delete *aiter;
+              if(child_g > bound)
+                {
+                  delete child;
+                  continue;
+                }
+              /* reservoir sampling keeps each of the tied children with equal chance */
+              if(best == 0 || child_h < best_h)
+                {
+                  ties = 1;
+                }
+              else if(child_h == best_h)
+                {
+                  ties++;
+                  if(std::uniform_int_distribution<unsigned int>(0, ties - 1)(random) != 0)
+                    {
+                      delete child;
+                      continue;
+                    }
+                }
+              else
+                {
+                  delete child;
+                  continue;
+                }
+              delete best;
+              best   = child;
+              best_g = child_g;
+              best_h = child_h;
+            }
+          if(state != problem->GetInitialState())
+            {
+              delete state;
+            }
+          state = best;
+          g = best_g;
+          if(!state)
+            {
+              break;
+            }
+        }
+      if(state && state != problem->GetInitialState())
+        {
+          delete state;
+        }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      seconds += elapsed.count();
+    }
+
+    unsigned int Estimator::GetProbeCount() const
+    {
+      return probe_count;
+    }
+
+    double Estimator::GetGoalCost() const
+    {
+      return goal_cost;
+    }
+
+    std::uint64_t Estimator::GetNodesGenerated() const
+    {
+      return nodes_generated;
+    }
+
+    double Estimator::GetSeconds() const
+    {
+      return seconds;
+    }
+
+    size_t Estimator::NodeBytes()
+    {
+      State *state = problem->GetInitialState();
+      std::vector<Action *> actions = problem->Actions(state);
+      if(actions.empty())
+        {
+          return HeapBlockBytes(sizeof(Node)) + state->MemoryBytes();
+        }
+      Node node(problem->Result(state, actions[0]), 0, actions[0], 0.0, 0.0, 1);
+      ClosedList closed;
+      closed.Insert(&node);
+      size_t bytes = node.MemoryBytes() + Node::CHILD_LINK_BYTES + closed.MemoryBytes() + sizeof(Node *);
+      std::vector<Action *>::iterator aiter;
+      for(aiter = actions.begin() + 1; aiter != actions.end(); aiter++)
+        {
+          delete *aiter;
+        }
+      return bytes;
+    }
+
+    double Estimator::Probe(double threshold)
+    {
+      State *state = problem->GetInitialState();
+      double g = 0.0;
+      double estimate = 1.0;
+      double weight = 1.0;
+      std::vector<State *> children;
+      std::vector<double> costs;
+      unsigned int depth;
+
+      for(depth = 0; depth < MAX_PROBE_DEPTH; depth++)
+        {
+          if(problem->GoalTest(state))
+            { // the search would stop here
+              if(g < goal_cost)
+                {
+                  goal_cost = g;
+                }
+              break;
+            }
+          std::vector<Action *> actions = problem->Actions(state);
+          std::vector<Action *>::iterator aiter;
+          for(aiter = actions.begin(); aiter != actions.end(); aiter++)
+            {
+              State *child = problem->Result(state, *aiter);
+              double child_g = g + problem->StepCost(state, *aiter, child);
+              nodes_generated++;
+              if(child_g + problem->BoundedHeuristic(child, threshold - child_g) <= threshold)
+                {
+                  children.push_back(child);
+                  costs.push_back(child_g);
+                }
+              else
+                {
+                  delete child;
+                }
+              delete *aiter;
+            }
+          if(state != problem->GetInitialState())
+            {
+              delete state;
+            }
+          state = 0;
+          if(children.empty())
+            {
+              break;
+            }
+
+          weight *= children.size();
+          estimate += weight;
+          size_t chosen = std::uniform_int_distribution<size_t>(0, children.size() - 1)(random);
+          state = children[chosen];
+          g = costs[chosen];
+          children[chosen] = 0;
+          std::vector<State *>::iterator siter;
+          for(siter = children.begin(); siter != children.end(); siter++)
+            {
+              delete *siter;
+            }
+          children.clear();
+          costs.clear();
+        }
+      if(state && state != problem->GetInitialState())
+        {
+          delete state;
+        }
+      return estimate;
+    }
+
+  }
+}
@@ -1,4 +1,5 @@
 #include "ai_search.h"
+#include <limits>
 
 namespace ai
 {
@@ -10,5 +11,15 @@ namespace ai
     Frontier::~Frontier()
     {
     }
+
+    double Frontier::GetCostBound() const
+    {
+      return std::numeric_limits<double>::infinity();
+    }
+
+    size_t Frontier::MemoryBytes() const
+    {
+      return Size() * sizeof(Node *);
+    }
   }
 }
@@ -32,6 +32,11 @@ namespace ai
       return frontier.size();
     }
 
+    size_t GreedyFrontier::MemoryBytes() const
+    {
+      return VectorHeapBytes(AdaptorContainer(frontier));
+    }
+
     GreedyFrontier::NodePtr::NodePtr(Node *node_in)
     {
       ptr = node_in;
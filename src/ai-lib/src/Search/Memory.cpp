@@ -0,0 +1,35 @@
+#include "ai_search.h"
+
+namespace ai
+{
+  namespace Search
+  {
+    size_t HeapBlockBytes(size_t n)
+    {
+      const size_t header = 8;
+      const size_t alignment = 16;
+      const size_t minimum = 32;
+      size_t bytes = (n + header + alignment - 1) & ~(alignment - 1);
+      return bytes < minimum ? minimum : bytes;
+    }
+
+    size_t StringHeapBytes(const std::string &s)
+    {
+      const char *begin = reinterpret_cast<const char *>(&s);
+      if(s.data() >= begin && s.data() < begin + sizeof(s))
+        { // short string stored in the object
+          return 0;
+        }
+      return HeapBlockBytes(s.capacity() + 1);
+    }
+
+    size_t DequeBlockBytes(size_t size, size_t element_bytes)
+    {
+      const size_t chunk_bytes = 512;
+      const size_t per_chunk = element_bytes < chunk_bytes ? chunk_bytes / element_bytes : 1;
+      const size_t chunks = size / per_chunk + 1;
+      const size_t map_entries = chunks + 2 < 8 ? 8 : chunks + 2;
+      return chunks * HeapBlockBytes(per_chunk * element_bytes) + HeapBlockBytes(map_entries * sizeof(void *));
+    }
+  }
+}
@@ -115,6 +115,23 @@ namespace ai
       return depth;
     }
 
+    /* a std::list node: two links and the pointer */
+    const size_t Node::CHILD_LINK_BYTES = HeapBlockBytes(3 * sizeof(Node *));
+
+    size_t  Node::MemoryBytes() const
+    {
+      size_t bytes = HeapBlockBytes(sizeof(Node));
+      if(state)
+        {
+          bytes += state->MemoryBytes();
+        }
+      if(action)
+        {
+          bytes += action->MemoryBytes();
+        }
+      return bytes;
+    }
+
     bool    Node::AddChild(Node *node_in)
     {
       children.push_back(node_in);
@@ -0,0 +1,186 @@
+#include "ai_search.h"
+#include <cerrno>
+#include <cstring>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ai
+{
+  namespace Search
+  {
+    PerfCounters::PerfCounters()
+      : leader_fd(-1), open_count(0)
+    {
+      int i;
+      for(i = 0; i < E_MAX; i++)
+        {
+          fds[i]        = -1;
+          read_index[i] = -1;
+        }
+    }
+
+    PerfCounters::~PerfCounters()
+    {
+      Close();
+    }
+
+#ifdef __linux__
+    /* type and config of each EventType */
+    static void event_attr(PerfCounters::EventType event, struct perf_event_attr &attr)
+    {
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      switch(event)
+        {
+        case PerfCounters::E_CYCLES:
+          attr.config = PERF_COUNT_HW_CPU_CYCLES;
+          break;
+        case PerfCounters::E_INSTRUCTIONS:
+          attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+          break;
+        case PerfCounters::E_L1D_MISSES:
+          attr.type   = PERF_TYPE_HW_CACHE;
+          attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+          break;
+        case PerfCounters::E_LLC_MISSES:
+          attr.config = PERF_COUNT_HW_CACHE_MISSES;
+          break;
+        case PerfCounters::E_BRANCH_MISSES:
+          attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+          break;
+        default:
+          break;
+        }
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    }
+
+    static std::string open_error(int error_number)
+    {
+      std::string reason = std::strerror(error_number);
+      if(error_number == EACCES || error_number == EPERM)
+        {
+          reason += ", see /proc/sys/kernel/perf_event_paranoid or the container's seccomp profile";
+        }
+      else if(error_number == ENOENT || error_number == ENODEV || error_number == EOPNOTSUPP)
+        {
+          reason += ", the processor or virtual machine has no such counters";
+        }
+      return reason;
+    }
+#endif
+
+    bool PerfCounters::Open()
+    {
+      Close();
+#ifdef __linux__
+      int first_errno = 0;
+      int i;
+      for(i = 0; i < E_MAX; i++)
+        {
+          struct perf_event_attr attr;
+          event_attr(static_cast<EventType>(i), attr);
+          int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, leader_fd, PERF_FLAG_FD_CLOEXEC));
+          if(fd < 0)
+            {
+              if(first_errno == 0)
+                {
+                  first_errno = errno;
+                }
+              continue;
+            }
+          if(leader_fd < 0)
+            {
+              leader_fd = fd;
+            }
+          fds[i]        = fd;
+          read_index[i] = open_count++;
+        }
+      if(open_count == 0)
+        {
+          error = "perf_event_open: " + open_error(first_errno);
+          return false;
+        }
+      error = "";
+      return true;
+#else
+      error = "hardware counters need Linux perf_event_open";
+      return false;
+#endif
+    }
+
+    void PerfCounters::Close()
+    {
+#ifdef __linux__
+      int i;
+      for(i = 0; i < E_MAX; i++)
+        {
+          if(fds[i] >= 0)
+            {
+              close(fds[i]);
+            }
+          fds[i]        = -1;
+          read_index[i] = -1;
+        }
+#endif
+      leader_fd  = -1;
+      open_count = 0;
+    }
+
+    bool PerfCounters::IsOpen() const
+    {
+      return open_count > 0;
+    }
+
+    bool PerfCounters::IsAvailable(EventType event) const
+    {
+      return read_index[event] >= 0;
+    }
+
+    const std::string &PerfCounters::GetError() const
+    {
+      return error;
+    }
+
+    void PerfCounters::Read(std::uint64_t values[E_MAX]) const
+    {
+      int i;
+      for(i = 0; i < E_MAX; i++)
+        {
+          values[i] = 0;
+        }
+#ifdef __linux__
+      if(leader_fd < 0)
+        {
+          return;
+        }
+      /* number of events, time enabled, time running, then the values */
+      std::uint64_t buffer[3 + E_MAX];
+      ssize_t bytes = read(leader_fd, buffer, sizeof(buffer));
+      if(bytes < static_cast<ssize_t>(3 * sizeof(std::uint64_t)))
+        {
+          return;
+        }
+      const double scale = (buffer[2] > 0 && buffer[2] < buffer[1]) ? static_cast<double>(buffer[1]) / buffer[2] : 1.0;
+      for(i = 0; i < E_MAX; i++)
+        {
+          if(read_index[i] >= 0 && static_cast<std::uint64_t>(read_index[i]) < buffer[0])
+            {
+              values[i] = static_cast<std::uint64_t>(buffer[3 + read_index[i]] * scale);
+            }
+        }
+#endif
+    }
+
+    const char *PerfCounters::EventName(EventType event)
+    {
+      static const char *names[E_MAX] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+      return names[event];
+    }
+  }
+}
@@ -36,5 +36,10 @@ namespace ai
       return 0.0;
     }
 
+    double Problem::BoundedHeuristic(const State  * const state_in, double /*bound_in*/) const
+    {
+      return Heuristic(state_in);
+    }
+
   }
 } /* ai */
@@ -15,5 +15,15 @@ namespace ai
       std::cout << "State Display.  Override me to get better information." << std::endl;
     }
 
+    size_t State::MemoryBytes() const
+    {
+      return HeapBlockBytes(sizeof(State));
+    }
+
+    std::uint64_t State::Fingerprint() const
+    {
+      return 0;
+    }
+
   }
 }
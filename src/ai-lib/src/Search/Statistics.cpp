@@ -0,0 +1,377 @@
+#include "ai_search.h"
+#include <iomanip>
+#include <string>
+
+namespace ai
+{
+  namespace Search
+  {
+    Statistics::Statistics()
+    {
+      Clear();
+    }
+
+    void Statistics::Clear()
+    {
+      int i;
+      for(i = 0; i < C_MAX; i++)
+        {
+          counters[i] = 0;
+        }
+      for(i = 0; i < T_MAX; i++)
+        {
+          timer_calls[i]      = 0;
+          timer_samples[i]    = 0;
+          timer_sampled_ns[i] = 0;
+        }
+      peak_frontier = 0;
+      peak_closed   = 0;
+      peak_bytes    = 0;
+
+      allocations_counted = false;
+      allocations = allocations_start = AllocationProfile::Counts();
+
+      perf_counters    = 0;
+      events_requested = false;
+      events_error     = "";
+      int e;
+      for(e = 0; e < PerfCounters::E_MAX; e++)
+        {
+          events_available[e] = false;
+          events_start[e]     = 0;
+          events[e]           = 0;
+          for(i = 0; i < T_MAX; i++)
+            {
+              timer_events[i][e] = 0;
+            }
+        }
+    }
+
+    void Statistics::Add(const Statistics &rhs)
+    {
+      int i;
+      for(i = 0; i < C_MAX; i++)
+        {
+          counters[i] += rhs.counters[i];
+        }
+      for(i = 0; i < T_MAX; i++)
+        {
+          timer_calls[i]      += rhs.timer_calls[i];
+          timer_samples[i]    += rhs.timer_samples[i];
+          timer_sampled_ns[i] += rhs.timer_sampled_ns[i];
+        }
+      UpdatePeakFrontier(rhs.peak_frontier);
+      UpdatePeakClosed(rhs.peak_closed);
+      UpdatePeakBytes(rhs.peak_bytes);
+
+      allocations_counted = allocations_counted || rhs.allocations_counted;
+      int c;
+      for(c = 0; c < AllocationProfile::SIZE_CLASSES; c++)
+        {
+          allocations.allocations[c] += rhs.allocations.allocations[c];
+          allocations.frees[c]       += rhs.allocations.frees[c];
+        }
+      allocations.bytes_allocated += rhs.allocations.bytes_allocated;
+      allocations.bytes_freed     += rhs.allocations.bytes_freed;
+
+      events_requested = events_requested || rhs.events_requested;
+      if(events_error == "")
+        {
+          events_error = rhs.events_error;
+        }
+      int e;
+      for(e = 0; e < PerfCounters::E_MAX; e++)
+        {
+          events_available[e] = events_available[e] || rhs.events_available[e];
+          events[e] += rhs.events[e];
+          for(i = 0; i < T_MAX; i++)
+            {
+              timer_events[i][e] += rhs.timer_events[i][e];
+            }
+        }
+    }
+
+    void Statistics::StartEvents(const PerfCounters &counters)
+    {
+      events_requested = true;
+      events_error     = counters.GetError();
+      int e;
+      for(e = 0; e < PerfCounters::E_MAX; e++)
+        {
+          events_available[e] = counters.IsAvailable(static_cast<PerfCounters::EventType>(e));
+        }
+      perf_counters = counters.IsOpen() ? &counters : 0;
+      if(perf_counters)
+        {
+          perf_counters->Read(events_start);
+        }
+    }
+
+    void Statistics::UpdateEvents()
+    {
+      if(!perf_counters)
+        {
+          return;
+        }
+      std::uint64_t now[PerfCounters::E_MAX];
+      perf_counters->Read(now);
+      int e;
+      for(e = 0; e < PerfCounters::E_MAX; e++)
+        {
+          events[e] = now[e] - events_start[e];
+        }
+    }
+
+    void Statistics::StartAllocations()
+    {
+      allocations_counted = AllocationProfile::IsEnabled();
+      if(allocations_counted)
+        {
+          AllocationProfile::Read(allocations_start);
+        }
+    }
+
+    void Statistics::UpdateAllocations()
+    {
+      if(!allocations_counted)
+        {
+          return;
+        }
+      AllocationProfile::Counts now;
+      AllocationProfile::Read(now);
+      AllocationProfile::Subtract(now, allocations_start, allocations);
+    }
+
+    void Statistics::AddTimerEvents(TimerType timer, const std::uint64_t start[PerfCounters::E_MAX])
+    {
+      std::uint64_t now[PerfCounters::E_MAX];
+      perf_counters->Read(now);
+      int e;
+      for(e = 0; e < PerfCounters::E_MAX; e++)
+        {
+          timer_events[timer][e] += now[e] - start[e];
+        }
+    }
+
+    std::uint64_t Statistics::GetCounter(CounterType counter) const
+    {
+      return counters[counter];
+    }
+
+    size_t Statistics::GetPeakFrontier() const
+    {
+      return peak_frontier;
+    }
+
+    size_t Statistics::GetPeakClosed() const
+    {
+      return peak_closed;
+    }
+
+    size_t Statistics::GetPeakBytes() const
+    {
+      return peak_bytes;
+    }
+
+    std::uint64_t Statistics::GetTimerCalls(TimerType timer) const
+    {
+      return timer_calls[timer];
+    }
+
+    double Statistics::GetTimerSeconds(TimerType timer) const
+    {
+      if(timer_samples[timer] == 0)
+        {
+          return 0.0;
+        }
+      return 1e-9 * timer_sampled_ns[timer] * timer_calls[timer] / timer_samples[timer];
+    }
+
+    bool Statistics::GetEventAvailable(PerfCounters::EventType event) const
+    {
+      return events_available[event];
+    }
+
+    std::uint64_t Statistics::GetEvents(PerfCounters::EventType event) const
+    {
+      return events[event];
+    }
+
+    double Statistics::GetTimerEvents(TimerType timer, PerfCounters::EventType event) const
+    {
+      if(timer_samples[timer] == 0)
+        {
+          return 0.0;
+        }
+      return static_cast<double>(timer_events[timer][event]) * timer_calls[timer] / timer_samples[timer];
+    }
+
+    bool Statistics::GetAllocationsCounted() const
+    {
+      return allocations_counted;
+    }
+
+    const AllocationProfile::Counts &Statistics::GetAllocations() const
+    {
+      return allocations;
+    }
+
+    const char *Statistics::CounterName(CounterType counter)
+    {
+      static const char *names[C_MAX] = { "expansions", "goal_tests", "heuristic_calls",
+                                          "closed_hits_on_pop", "closed_hits_on_generation", "frontier_rejections" };
+      return names[counter];
+    }
+
+    const char *Statistics::TimerName(TimerType timer)
+    {
+      static const char *names[T_MAX] = { "expansion", "heuristic", "closed_list", "frontier" };
+      return names[timer];
+    }
+
+    static double allocations_per_expansion(std::uint64_t allocations, std::uint64_t expansions)
+    {
+      return static_cast<double>(allocations) / (expansions > 0 ? expansions : 1);
+    }
+
+    /* the largest usable size in the class, "large" for the last */
+    static std::string size_class_name(int size_class)
+    {
+      size_t limit = AllocationProfile::SizeClassLimit(size_class);
+      return limit > 0 ? std::to_string(limit) : "large";
+    }
+
+    void Statistics::Display(std::ostream &os) const
+    {
+      int i;
+      for(i = 0; i < C_MAX; i++)
+        {
+          os << std::left << std::setw(27) << CounterName(static_cast<CounterType>(i)) << std::right << counters[i] << std::endl;
+        }
+      os << std::left << std::setw(27) << "peak_frontier" << std::right << peak_frontier << std::endl;
+      os << std::left << std::setw(27) << "peak_closed" << std::right << peak_closed << std::endl;
+      os << std::left << std::setw(27) << "peak_bytes" << std::right << peak_bytes << std::endl;
+      for(i = 0; i < T_MAX; i++)
+        {
+          TimerType timer = static_cast<TimerType>(i);
+          os << std::left << std::setw(27) << (std::string(TimerName(timer)) + "_seconds") << std::right
+             << GetTimerSeconds(timer) << " (" << timer_calls[i] << " calls, " << timer_samples[i] << " timed)" << std::endl;
+        }
+      if(allocations_counted)
+        {
+          std::uint64_t total = AllocationProfile::TotalAllocations(allocations);
+          std::uint64_t frees = AllocationProfile::TotalFrees(allocations);
+          os << std::left << std::setw(27) << "allocations" << std::right << total
+             << " (" << allocations_per_expansion(total, counters[C_EXPANSIONS]) << " per expansion)" << std::endl;
+          os << std::left << std::setw(27) << "allocated_bytes" << std::right << allocations.bytes_allocated << std::endl;
+          os << std::left << std::setw(27) << "frees" << std::right << frees << std::endl;
+          os << std::left << std::setw(27) << "live_allocations" << std::right << static_cast<std::int64_t>(total - frees)
+             << " (" << static_cast<std::int64_t>(allocations.bytes_allocated - allocations.bytes_freed) << " bytes)" << std::endl;
+          os << std::left << std::setw(27) << "allocations_by_size" << std::right;
+          int c;
+          for(c = 0; c < AllocationProfile::SIZE_CLASSES; c++)
+            {
+              os << (c > 0 ? " " : "") << size_class_name(c) << ":" << allocations.allocations[c];
+            }
+          os << std::endl;
+          os << std::left << std::setw(27) << "live_by_size" << std::right;
+          for(c = 0; c < AllocationProfile::SIZE_CLASSES; c++)
+            {
+              os << (c > 0 ? " " : "") << size_class_name(c) << ":"
+                 << static_cast<std::int64_t>(allocations.allocations[c] - allocations.frees[c]);
+            }
+          os << std::endl;
+        }
+      if(!events_requested)
+        {
+          return;
+        }
+      if(events_error != "")
+        {
+          os << std::left << std::setw(27) << "perf_events" << std::right << "unavailable (" << events_error << ")" << std::endl;
+          return;
+        }
+      int e;
+      for(e = 0; e < PerfCounters::E_MAX; e++)
+        {
+          if(events_available[e])
+            {
+              os << std::left << std::setw(27) << PerfCounters::EventName(static_cast<PerfCounters::EventType>(e)) << std::right << events[e] << std::endl;
+            }
+        }
+      for(i = 0; i < T_MAX; i++)
+        {
+          TimerType timer = static_cast<TimerType>(i);
+          os << std::left << std::setw(27) << (std::string(TimerName(timer)) + "_events") << std::right;
+          const char *separator = "";
+          for(e = 0; e < PerfCounters::E_MAX; e++)
+            {
+              if(events_available[e])
+                {
+                  os << separator << PerfCounters::EventName(static_cast<PerfCounters::EventType>(e)) << " "
+                     << GetTimerEvents(timer, static_cast<PerfCounters::EventType>(e));
+                  separator = " ";
+                }
+            }
+          os << std::endl;
+        }
+    }
+
+    void Statistics::DisplayFields(std::ostream &os) const
+    {
+      int i;
+      for(i = 0; i < C_MAX; i++)
+        {
+          if(i > 0)
+            {
+              os << " ";
+            }
+          os << CounterName(static_cast<CounterType>(i)) << " " << counters[i];
+        }
+      os << " peak_frontier " << peak_frontier;
+      os << " peak_closed " << peak_closed;
+      os << " peak_bytes " << peak_bytes;
+      for(i = 0; i < T_MAX; i++)
+        {
+          TimerType timer = static_cast<TimerType>(i);
+          os << " " << TimerName(timer) << "_seconds " << GetTimerSeconds(timer);
+        }
+      if(allocations_counted)
+        {
+          std::uint64_t total = AllocationProfile::TotalAllocations(allocations);
+          std::uint64_t frees = AllocationProfile::TotalFrees(allocations);
+          os << " allocations " << total
+             << " allocations_per_expansion " << allocations_per_expansion(total, counters[C_EXPANSIONS])
+             << " allocated_bytes " << allocations.bytes_allocated
+             << " frees " << frees
+             << " live_allocations " << static_cast<std::int64_t>(total - frees)
+             << " live_bytes " << static_cast<std::int64_t>(allocations.bytes_allocated - allocations.bytes_freed);
+          int c;
+          for(c = 0; c < AllocationProfile::SIZE_CLASSES; c++)
+            {
+              os << " allocations_" << size_class_name(c) << " " << allocations.allocations[c];
+            }
+        }
+      if(events_requested && events_error != "")
+        {
+          os << " perf_events unavailable";
+        }
+      int e;
+      for(e = 0; e < PerfCounters::E_MAX; e++)
+        {
+          if(!events_available[e])
+            {
+              continue;
+            }
+          PerfCounters::EventType event = static_cast<PerfCounters::EventType>(e);
+          os << " " << PerfCounters::EventName(event) << " " << events[e];
+          for(i = 0; i < T_MAX; i++)
+            {
+              TimerType timer = static_cast<TimerType>(i);
+              os << " " << TimerName(timer) << "_" << PerfCounters::EventName(event) << " " << GetTimerEvents(timer, event);
+            }
+        }
+    }
+
+  }
+}
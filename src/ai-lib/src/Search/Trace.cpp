@@ -0,0 +1,150 @@
+#include "ai_search.h"
+#include <cstring>
+
+namespace ai
+{
+  namespace Search
+  {
+    TraceSink::TraceSink()
+      : next_search(0)
+    {
+    }
+
+    TraceSink::~TraceSink()
+    {
+    }
+
+    std::uint32_t TraceSink::BeginSearch()
+    {
+      return next_search++;
+    }
+
+    const char TraceFileWriter::MAGIC[8] = { 'A', 'I', 'T', 'R', 'A', 'C', 'E', '\n' };
+
+    TraceFileWriter::TraceFileWriter()
+      : writing_full(false), stopping(false), record_count(0)
+    {
+    }
+
+    TraceFileWriter::~TraceFileWriter()
+    {
+      Close();
+    }
+
+    bool TraceFileWriter::Open(const std::string &filename_in)
+    {
+      Close();
+      fout.open(filename_in.c_str(), std::ios::binary | std::ios::trunc);
+      if(!fout)
+        {
+          return false;
+        }
+      filename = filename_in;
+      std::uint32_t header[2] = { VERSION, sizeof(TraceRecord) };
+      fout.write(MAGIC, sizeof(MAGIC));
+      fout.write(reinterpret_cast<const char *>(header), sizeof(header));
+      filling.reserve(BUFFER_RECORDS);
+      writing.reserve(BUFFER_RECORDS);
+      stopping = false;
+      record_count = 0;
+      writer = std::thread(&TraceFileWriter::WriterThread, this);
+      return true;
+    }
+
+    void TraceFileWriter::Close()
+    {
+      if(!writer.joinable())
+        {
+          return;
+        }
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if(!filling.empty())
+          {
+            HandOff(lock);
+          }
+        stopping = true;
+        changed.notify_all();
+      }
+      writer.join();
+      fout.close();
+    }
+
+    bool TraceFileWriter::IsOpen() const
+    {
+      return writer.joinable();
+    }
+
+    const std::string &TraceFileWriter::GetFilename() const
+    {
+      return filename;
+    }
+
+    std::uint64_t TraceFileWriter::GetRecordCount() const
+    {
+      return record_count;
+    }
+
+    void TraceFileWriter::Record(const TraceRecord &record)
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      filling.push_back(record);
+      record_count++;
+      if(filling.size() >= BUFFER_RECORDS)
+        {
+          HandOff(lock);
+        }
+    }
+
+    /* waits for the writer to finish the previous buffer, then gives it this one */
+    void TraceFileWriter::HandOff(std::unique_lock<std::mutex> &lock)
+    {
+      changed.wait(lock, [this] { return !writing_full; });
+      filling.swap(writing);
+      writing_full = true;
+      changed.notify_all();
+    }
+
+    void TraceFileWriter::WriterThread()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while(true)
+        {
+          changed.wait(lock, [this] { return writing_full || stopping; });
+          if(writing_full)
+            {
+              /* the searches may fill the other buffer meanwhile */
+              lock.unlock();
+              fout.write(reinterpret_cast<const char *>(writing.data()), writing.size() * sizeof(TraceRecord));
+              writing.clear();
+              lock.lock();
+              writing_full = false;
+              changed.notify_all();
+            }
+          else if(stopping)
+            {
+              break;
+            }
+        }
+      fout.flush();
+    }
+
+    bool TraceFileReader::Open(const std::string &filename)
+    {
+      fin.open(filename.c_str(), std::ios::binary);
+      char magic[sizeof(TraceFileWriter::MAGIC)];
+      std::uint32_t header[2];
+      if(!fin.read(magic, sizeof(magic)) || !fin.read(reinterpret_cast<char *>(header), sizeof(header)))
+        {
+          return false;
+        }
+      return std::memcmp(magic, TraceFileWriter::MAGIC, sizeof(magic)) == 0 &&
+        header[0] == TraceFileWriter::VERSION && header[1] == sizeof(TraceRecord);
+    }
+
+    bool TraceFileReader::Next(TraceRecord &record)
+    {
+      return static_cast<bool>(fin.read(reinterpret_cast<char *>(&record), sizeof(record)));
+    }
+  }
+}
@@ -15,6 +15,8 @@ namespace ai
 
     bool Tree::Search()
     {
+      /* counting stays on from SearchInit through SearchNext */
+      AllocationProfile::Scope allocation_scope(allocation_enabled);
       if(!SearchInit())
         {
           return false;
@@ -24,6 +26,7 @@ namespace ai
 
     bool Tree::SearchInit()
     {
+      AllocationProfile::Scope allocation_scope(allocation_enabled);
       if(root)
         {
           delete root;
@@ -32,58 +35,119 @@ namespace ai
       // Count the root
       number_nodes_generated = 1;
       max_nodes_stored       = 1;
+      statistics.Clear();
+      StartPerfCounters();
+      statistics.StartAllocations();
       
-      root = new Node(problem->GetInitialState(), 0, 0, 0.0, problem->Heuristic(problem->GetInitialState()), 0);
+      double h;
+      {
+        Statistics::ScopedTimer timer(statistics, Statistics::T_HEURISTIC);
+        statistics.Count(Statistics::C_HEURISTIC_CALLS);
+        h = problem->BoundedHeuristic(problem->GetInitialState(), frontier->GetCostBound());
+      }
+      StartProgress();
+      StartTrace();
+      best_heuristic = h;
+      root = new Node(problem->GetInitialState(), 0, 0, 0.0, h, 0);
+      node_bytes = bytes_stored = root->MemoryBytes();
+      statistics.UpdatePeakBytes(bytes_stored);
       frontier->Insert(root);
+      statistics.UpdatePeakFrontier(frontier->Size());
       return true;
     }
 
     bool Tree::SearchNext()
     {
+      AllocationProfile::Scope allocation_scope(allocation_enabled);
       while(!frontier->Empty() &&
             (generation_limit == 0 || generation_limit > number_nodes_generated) &&
-            (store_limit == 0 || store_limit > max_nodes_stored)
+            (store_limit == 0 || store_limit > max_nodes_stored) &&
+            (memory_limit == 0 || memory_limit > bytes_stored)
             )
         {
-          Node *node = frontier->Remove();
+          Node *node;
+          {
+            Statistics::ScopedTimer timer(statistics, Statistics::T_FRONTIER);
+            node = frontier->Remove();
+          }
+          CheckProgress(node, 0);
 
           State *s1 = node->GetState();
+          statistics.Count(Statistics::C_GOAL_TESTS);
           if(problem->GoalTest(s1))
             {
               solution.SetFromNode(node);
+              statistics.UpdateEvents();
+              statistics.UpdateAllocations();
               return true;
             }
 
-          std::vector<Action *> actions = problem->Actions(s1);
+          statistics.Count(Statistics::C_EXPANSIONS);
+          std::vector<Action *> actions;
+          {
+            Statistics::ScopedTimer timer(statistics, Statistics::T_EXPANSION);
+            actions = problem->Actions(s1);
+          }
           std::vector<Action *>::iterator aiter;
+          unsigned int children = 0, duplicates = 0;
 
           for(aiter = actions.begin(); aiter != actions.end(); aiter++)
             {
-              State *s2 = problem->Result(s1, *aiter);
-
+              State *s2;
+              double path_cost;
+              {
+                Statistics::ScopedTimer timer(statistics, Statistics::T_EXPANSION);
+                s2 = problem->Result(s1, *aiter);
+                path_cost = node->GetPathCost() + problem->StepCost(s1, *aiter, s2);
+              }
+              double h;
+              {
+                Statistics::ScopedTimer timer(statistics, Statistics::T_HEURISTIC);
+                statistics.Count(Statistics::C_HEURISTIC_CALLS);
+                h = problem->BoundedHeuristic(s2, frontier->GetCostBound() - path_cost);
+              }
+              if(h < best_heuristic)
+                {
+                  best_heuristic = h;
+                }
               Node *new_node = new Node(s2,     // new state
                                         node,   // parent node
                                         *aiter, // action
-                                        (node->GetPathCost() + problem->StepCost(s1, *aiter, s2)), // total path cost
-                                        problem->Heuristic(s2), // heuristic
+                                        path_cost, // total path cost
+                                        h,      // heuristic
                                         (node->GetDepth() + 1)  // depth in tree
                                         );
               // Add to frontier
-              if(!frontier->Insert(new_node))
+              bool inserted;
+              {
+                Statistics::ScopedTimer timer(statistics, Statistics::T_FRONTIER);
+                inserted = frontier->Insert(new_node);
+              }
+              if(!inserted)
                 { // depth limited, is full, etc.
+                  statistics.Count(Statistics::C_FRONTIER_REJECTIONS);
                   delete new_node;
                   continue;
                 }
               
               // Forward links in tree
               node->AddChild(new_node);
+              children++;
               
               // Statistics
               number_nodes_generated++;
               max_nodes_stored = std::max(max_nodes_stored, frontier->Size());
+              statistics.UpdatePeakFrontier(frontier->Size());
+              node_bytes += new_node->MemoryBytes() + Node::CHILD_LINK_BYTES;
+              bytes_stored = node_bytes + frontier->MemoryBytes();
+              statistics.UpdatePeakBytes(bytes_stored);
             }
+          TraceExpansion(node, children, duplicates);
           deleteNodeIfNeeded( node );
+          bytes_stored = node_bytes + frontier->MemoryBytes();
         }
+      statistics.UpdateEvents();
+      statistics.UpdateAllocations();
       return false;
     }
 
@@ -93,8 +157,10 @@ namespace ai
         if ( node->GetChildCount( ) == 0 ) {
           
           Node *parent = node->GetParent( );
+          node_bytes -= node->MemoryBytes( );
           /* disconnect from parent */
           if ( parent ) {
+            node_bytes -= Node::CHILD_LINK_BYTES;
             parent->RemoveChild( node );
             node->RemoveParent( );
           } else {
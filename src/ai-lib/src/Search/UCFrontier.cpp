@@ -32,6 +32,11 @@ namespace ai
       return frontier.size();
     }
 
+    size_t UCFrontier::MemoryBytes() const
+    {
+      return VectorHeapBytes(AdaptorContainer(frontier));
+    }
+
     UCFrontier::NodePtr::NodePtr(Node *node_in)
     {
       ptr = node_in;
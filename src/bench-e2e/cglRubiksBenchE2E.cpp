@@ -0,0 +1,465 @@
+#include "cglRubiksAppData.h"
+#include "cglRubiksSearch.h"
+#include "cglRubiksCube.h"
+#include "cglRubiksMoveSet.h"
+#include "cglRubiksRandom.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <malloc.h>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*********************************************
+     * Corpus
+     */
+
+    /* A corpus file has one record per line, `#` starts a comment.
+     *
+     *   goal name solved|cube_configuration+
+     *   scramble goal_name depth move+
+     *
+     * Each scramble is applied to a solved cube, and the search is to the
+     * named goal's cubes.  The depth is the number of scramble moves, so
+     * it bounds the solution length from above.
+     */
+    struct CorpusItem {
+      std::string                goal;
+      unsigned int               depth;
+      std::vector< std::string > moves;
+      Cube                       cube;
+    };
+
+    struct Corpus {
+      std::map< std::string, std::vector< Cube > > goals;
+      std::vector< CorpusItem >                    items;
+    };
+
+    static bool read_corpus( const std::string& filename, const MoveSet& move_set, Corpus& corpus ) {
+      std::ifstream fin( filename );
+      if( !fin ) {
+        std::cerr << "Unable to open the corpus '" << filename << "'." << std::endl;
+        return false;
+      }
+      std::string text;
+      int line_number = 0;
+      while( std::getline( fin, text ) ) {
+        line_number++;
+        std::stringstream ss( text );
+        std::vector< std::string > words;
+        std::string word;
+        while( ss >> word ) {
+          words.push_back( word );
+        }
+        if( words.size( ) == 0 || words[ 0 ][ 0 ] == '#' ) {
+          continue;
+        }
+
+        if( words[ 0 ] == "goal" && words.size( ) >= 3 ) {
+          std::vector< Cube >& cubes = corpus.goals[ words[ 1 ] ];
+          cubes.clear( );
+          for( auto it = words.begin( ) + 2; it != words.end( ); it++ ) {
+            cubes.push_back( Cube( ) );
+            if( *it == "solved" ) {
+              cubes.back( ).assignSolved( );
+            } else if( it->size( ) == cubes.back( ).getFacelets( ).size( ) ) {
+              cubes.back( ).assignFromString( *it );
+            } else {
+              std::cerr << filename << ":" << line_number << ": bad goal cube ( " << *it << " )" << std::endl;
+              return false;
+            }
+          }
+        } else if( words[ 0 ] == "scramble" && words.size( ) >= 4 ) {
+          CorpusItem item;
+          item.goal = words[ 1 ];
+          item.depth = std::atoi( words[ 2 ].c_str( ) );
+          item.cube.assignSolved( );
+          if( corpus.goals.find( item.goal ) == corpus.goals.end( ) ) {
+            std::cerr << filename << ":" << line_number << ": undefined goal ( " << item.goal << " )" << std::endl;
+            return false;
+          }
+          for( auto it = words.begin( ) + 3; it != words.end( ); it++ ) {
+            if( !move_set.moveExists( *it ) ) {
+              std::cerr << filename << ":" << line_number << ": unexpected move ( " << *it << " )" << std::endl;
+              return false;
+            }
+            item.moves.push_back( *it );
+            item.cube = move_set.getMove( *it ) * item.cube;
+          }
+          corpus.items.push_back( item );
+        } else {
+          std::cerr << filename << ":" << line_number << ": expected goal or scramble" << std::endl;
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /* The goals written by --make-corpus: the solved cube, the top face,
+     * and the top cross with its side colors.
+     */
+    static std::vector< std::pair< std::string, std::string > > corpus_goals( ) {
+      Cube solved;
+      solved.assignSolved( );
+      std::string facelets;
+      for( auto it = solved.getFacelets( ).begin( ); it != solved.getFacelets( ).end( ); it++ ) {
+        facelets += *it;
+      }
+      std::string top( facelets.size( ), '*' );
+      std::string cross( facelets.size( ), '*' );
+      const int top_positions[ ] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+      const int cross_positions[ ] = { 1, 3, 4, 5, 7, 10, 13, 19, 22, 28, 31, 37, 40 };
+      for( int i : top_positions ) {
+        top[ i ] = facelets[ i ];
+      }
+      for( int i : cross_positions ) {
+        cross[ i ] = facelets[ i ];
+      }
+      return { { "solved", "solved" }, { "top", top }, { "cross", cross } };
+    }
+
+    /* Writes per_depth scrambles of each depth 1 .. max_depth for each
+     * goal.  Consecutive moves never turn the same face, so scrambles do
+     * not cancel or merge.
+     */
+    static void write_corpus( std::ostream& os, const std::uint64_t seed, const unsigned int max_depth, const unsigned int per_depth ) {
+      static const std::vector< std::string > faces( { "U", "L", "F", "R", "B", "D" } );
+      Random random( seed );
+      os << "# End to end benchmark corpus, written by rubiks-bench-e2e --make-corpus " << max_depth << " " << per_depth << " --seed " << seed << std::endl;
+      const std::vector< std::pair< std::string, std::string > > goals = corpus_goals( );
+      for( auto goal = goals.begin( ); goal != goals.end( ); goal++ ) {
+        os << "goal " << goal->first << " " << goal->second << std::endl;
+      }
+      for( auto goal = goals.begin( ); goal != goals.end( ); goal++ ) {
+        unsigned int depth, i, k;
+        for( depth = 1; depth <= max_depth; depth++ ) {
+          for( i = 0; i < per_depth; i++ ) {
+            os << "scramble " << goal->first << " " << depth;
+            std::uint64_t last_face = faces.size( );
+            for( k = 0; k < depth; k++ ) {
+              std::uint64_t face;
+              do {
+                face = random.below( faces.size( ) );
+              } while( face == last_face );
+              last_face = face;
+              os << " " << faces[ face ] << ( random.below( 2 ) ? "'" : "" );
+            }
+            os << std::endl;
+          }
+        }
+      }
+    }
+
+    /*
+     * Corpus
+     *********************************************/
+
+    /*********************************************
+     * Measurement
+     */
+
+    /* Linux only: writing 5 to clear_refs resets the peak resident set
+     * size, so each run's peak can be read from VmHWM afterwards.  Freed
+     * memory is returned first, so earlier runs' peaks do not carry over.
+     */
+    static void reset_peak_rss( ) {
+      malloc_trim( 0 );
+      std::ofstream fout( "/proc/self/clear_refs" );
+      fout << "5";
+    }
+
+    /* peak resident set size in kB, or 0 if unknown */
+    static size_t peak_rss_kb( ) {
+      std::ifstream fin( "/proc/self/status" );
+      std::string text;
+      while( std::getline( fin, text ) ) {
+        if( text.compare( 0, 6, "VmHWM:" ) == 0 ) {
+          return std::strtoul( text.c_str( ) + 6, 0, 10 );
+        }
+      }
+      return 0;
+    }
+
+    struct RunResult {
+      std::string  algorithm;
+      std::string  frontier;
+      std::string  heuristic;
+      size_t       item;
+      int          status;       // EXIT_OK or the search's error
+      SearchResult search;
+      double       seconds;
+      size_t       peak_rss_kb;
+    };
+
+    /* Searches for one corpus item through search_core, the same path as
+     * the search command, with the solution cache off.
+     */
+    static RunResult run_item( AppData& data, const Corpus& corpus, const size_t item, const std::uint64_t seed ) {
+      RunResult run;
+      run.algorithm = data.words[ 1 ];
+      run.frontier = data.words[ 2 ];
+      run.item = item;
+      data.cube = corpus.items[ item ].cube;
+      data.goal_cubes = corpus.goals.at( corpus.items[ item ].goal );
+      /* every configuration tries moves in the same order for an item */
+      data.random = Random( seed ).stream( item );
+
+      reset_peak_rss( );
+      auto start = std::chrono::steady_clock::now( );
+      run.status = search_core( data, run.search );
+      std::chrono::duration< double > seconds = std::chrono::steady_clock::now( ) - start;
+      run.seconds = seconds.count( );
+      run.peak_rss_kb = peak_rss_kb( );
+      return run;
+    }
+
+    /*
+     * Measurement
+     *********************************************/
+
+    /*********************************************
+     * Reports
+     */
+
+    static void write_csv( std::ostream& os, const Corpus& corpus, const std::vector< RunResult >& runs ) {
+      os << "algorithm,frontier,heuristic,item,goal,depth,status,solved,cost,length,generated_nodes,stored_nodes,seconds,nodes_per_second,peak_rss_kb";
+      int e;
+      for( e = 0; e < ai::Search::PerfCounters::E_MAX; e++ ) {
+        os << "," << ai::Search::PerfCounters::EventName( static_cast< ai::Search::PerfCounters::EventType >( e ) );
+      }
+      os << std::endl;
+      for( auto it = runs.begin( ); it != runs.end( ); it++ ) {
+        const CorpusItem& item = corpus.items[ it->item ];
+        os << it->algorithm << "," << it->frontier << "," << it->heuristic << ","
+           << it->item << "," << item.goal << "," << item.depth << ","
+           << it->status << "," << ( it->search.solved ? 1 : 0 ) << ","
+           << it->search.cost << "," << it->search.moves.size( ) << ","
+           << it->search.generated_nodes << "," << it->search.stored_nodes << ","
+           << it->seconds << "," << ( it->seconds > 0.0 ? it->search.generated_nodes / it->seconds : 0.0 ) << ","
+           << it->peak_rss_kb;
+        /* empty unless the perf_counters configuration counted the event */
+        for( e = 0; e < ai::Search::PerfCounters::E_MAX; e++ ) {
+          const ai::Search::PerfCounters::EventType event = static_cast< ai::Search::PerfCounters::EventType >( e );
+          os << ",";
+          if( it->search.statistics.GetEventAvailable( event ) ) {
+            os << it->search.statistics.GetEvents( event );
+          }
+        }
+        os << std::endl;
+      }
+    }
+
+    /* One row per configuration, summed or maximized over its items. */
+    static void write_table( std::ostream& os, const std::vector< RunResult >& runs ) {
+      os << std::left << std::setw( 32 ) << "configuration" << std::right
+         << std::setw( 9 ) << "solved"
+         << std::setw( 12 ) << "generated"
+         << std::setw( 11 ) << "max stored"
+         << std::setw( 10 ) << "seconds"
+         << std::setw( 12 ) << "nodes/s"
+         << std::setw( 10 ) << "peak MB"
+         << std::setw( 10 ) << "mean cost" << std::endl;
+
+      auto first = runs.begin( );
+      while( first != runs.end( ) ) {
+        auto last = first;
+        unsigned int solved = 0, count = 0;
+        std::uint64_t generated = 0;
+        size_t stored = 0, rss = 0;
+        double seconds = 0.0, cost = 0.0;
+        while( last != runs.end( ) && last->algorithm == first->algorithm && last->frontier == first->frontier && last->heuristic == first->heuristic ) {
+          count++;
+          if( last->search.solved ) {
+            solved++;
+            cost += last->search.cost;
+          }
+          generated += last->search.generated_nodes;
+          stored = std::max( stored, last->search.stored_nodes );
+          rss = std::max( rss, last->peak_rss_kb );
+          seconds += last->seconds;
+          last++;
+        }
+        std::stringstream solved_text;
+        solved_text << solved << "/" << count;
+        os << std::left << std::setw( 32 ) << ( first->algorithm + " " + first->frontier + " " + first->heuristic ) << std::right
+           << std::setw( 9 ) << solved_text.str( )
+           << std::setw( 12 ) << generated
+           << std::setw( 11 ) << stored
+           << std::setw( 10 ) << std::fixed << std::setprecision( 3 ) << seconds
+           << std::setw( 12 ) << std::setprecision( 0 ) << ( seconds > 0.0 ? generated / seconds : 0.0 )
+           << std::setw( 10 ) << std::setprecision( 1 ) << rss / 1024.0
+           << std::setw( 10 ) << std::setprecision( 2 ) << ( solved > 0 ? cost / solved : 0.0 ) << std::endl;
+        os.unsetf( std::ios::floatfield );
+        os << std::setprecision( 6 );
+        first = last;
+      }
+    }
+
+    /*
+     * Reports
+     *********************************************/
+
+    static std::vector< std::string > split_list( const std::string& text ) {
+      std::vector< std::string > words;
+      std::stringstream ss( text );
+      std::string word;
+      while( std::getline( ss, word, ',' ) ) {
+        if( word != "" ) {
+          words.push_back( word );
+        }
+      }
+      return words;
+    }
+
+    static int usage( const char *program ) {
+      std::cerr << "usage: " << program << " [--corpus file] [--quick] [--algorithms a,b] [--frontiers f,g] [--heuristics h,i]" << std::endl
+                << "         [--goals g,h] [--max-depth n] [--config option=value]* [--seed n] [--csv file]" << std::endl
+                << "       " << program << " --make-corpus max_depth per_depth [--seed n]" << std::endl;
+      return 1;
+    }
+
+    static int bench_e2e_main( int argc, char **argv ) {
+      std::string corpus_file = "src/bench-e2e/corpus.txt";
+      std::string csv_file = "bench-e2e.csv";
+      std::vector< std::string > algorithms( { "tree", "graph" } );
+      std::vector< std::string > frontiers( { "astar", "bfs", "dfs", "dl", "ids", "bl", "al", "greedy", "uc" } );
+      std::vector< std::string > heuristics( { "zero", "facelet", "edge_facelet", "corner_facelet", "facelet_max", "color_count" } );
+      std::vector< std::string > goals;
+      std::vector< std::pair< std::string, std::string > > options;
+      unsigned int max_depth = 0;
+      std::uint64_t seed = 1;
+      int make_corpus_depth = 0, make_corpus_count = 0;
+
+      int i;
+      for( i = 1; i < argc; i++ ) {
+        std::string arg = argv[ i ];
+        if( arg == "--quick" ) {
+          /* the common configurations, each capped to stay quick */
+          algorithms = { "graph" };
+          frontiers = { "astar", "bfs", "ids", "greedy" };
+          heuristics = { "facelet", "corner_facelet" };
+          max_depth = 4;
+          options.push_back( { "generation_limit", "100000" } );
+        } else if( i + 1 < argc && arg == "--corpus" ) {
+          corpus_file = argv[ ++i ];
+        } else if( i + 1 < argc && arg == "--algorithms" ) {
+          algorithms = split_list( argv[ ++i ] );
+        } else if( i + 1 < argc && arg == "--frontiers" ) {
+          frontiers = split_list( argv[ ++i ] );
+        } else if( i + 1 < argc && arg == "--heuristics" ) {
+          heuristics = split_list( argv[ ++i ] );
+        } else if( i + 1 < argc && arg == "--goals" ) {
+          goals = split_list( argv[ ++i ] );
+        } else if( i + 1 < argc && arg == "--max-depth" ) {
+          max_depth = std::max( 0, std::atoi( argv[ ++i ] ) );
+        } else if( i + 1 < argc && arg == "--config" ) {
+          std::string option = argv[ ++i ];
+          size_t equals = option.find( '=' );
+          if( equals == std::string::npos ) {
+            return usage( argv[ 0 ] );
+          }
+          options.push_back( { option.substr( 0, equals ), option.substr( equals + 1 ) } );
+        } else if( i + 1 < argc && arg == "--seed" ) {
+          seed = std::strtoull( argv[ ++i ], 0, 10 );
+        } else if( i + 1 < argc && arg == "--csv" ) {
+          csv_file = argv[ ++i ];
+        } else if( i + 2 < argc && arg == "--make-corpus" ) {
+          make_corpus_depth = std::atoi( argv[ ++i ] );
+          make_corpus_count = std::atoi( argv[ ++i ] );
+        } else {
+          return usage( argv[ 0 ] );
+        }
+      }
+
+      if( make_corpus_depth > 0 && make_corpus_count > 0 ) {
+        write_corpus( std::cout, seed, make_corpus_depth, make_corpus_count );
+        return 0;
+      }
+
+      std::stringstream is, os;
+      AppData data( is, os );
+      Corpus corpus;
+      if( !read_corpus( corpus_file, *data.move_set, corpus ) ) {
+        return 1;
+      }
+
+      /* dl, bl and ids reach the deepest scramble unless configured otherwise */
+      unsigned int deepest = 0;
+      for( auto it = corpus.items.begin( ); it != corpus.items.end( ); it++ ) {
+        deepest = std::max( deepest, it->depth );
+      }
+      if( max_depth > 0 ) {
+        deepest = std::min( deepest, max_depth );
+      }
+      data.config.setDepthLimit( deepest );
+      data.config.setIDSLimit( deepest );
+      data.config.setDisplaySolutionMachine( );
+      for( auto it = options.begin( ); it != options.end( ); it++ ) {
+        if( !data.config.updateOption( it->first, it->second ) ) {
+          std::cerr << data.config.getUpdateOptionError( it->first, it->second ) << std::endl;
+          return 1;
+        }
+      }
+      data.setLegalMoves( );
+
+      std::vector< size_t > items;
+      size_t item;
+      for( item = 0; item < corpus.items.size( ); item++ ) {
+        const CorpusItem& c = corpus.items[ item ];
+        if( ( max_depth == 0 || c.depth <= max_depth ) &&
+            ( goals.empty( ) || std::find( goals.begin( ), goals.end( ), c.goal ) != goals.end( ) ) ) {
+          items.push_back( item );
+        }
+      }
+
+      std::vector< RunResult > runs;
+      for( auto algorithm = algorithms.begin( ); algorithm != algorithms.end( ); algorithm++ ) {
+        for( auto frontier = frontiers.begin( ); frontier != frontiers.end( ); frontier++ ) {
+          for( auto heuristic = heuristics.begin( ); heuristic != heuristics.end( ); heuristic++ ) {
+            if( !data.config.updateOption( "heuristic", *heuristic ) ) {
+              std::cerr << data.config.getUpdateOptionError( "heuristic", *heuristic ) << std::endl;
+              return 1;
+            }
+            data.words = { "search", *algorithm, *frontier };
+            for( auto it = items.begin( ); it != items.end( ); it++ ) {
+              runs.push_back( run_item( data, corpus, *it, seed ) );
+              RunResult& run = runs.back( );
+              run.heuristic = *heuristic;
+              if( run.status != EXIT_OK ) {
+                std::cerr << "search " << *algorithm << " " << *frontier << " failed, status " << run.status << "." << std::endl;
+                return 1;
+              }
+              std::cerr << *algorithm << " " << *frontier << " " << *heuristic << " item " << *it
+                        << ( run.search.solved ? " T " : " F " ) << run.search.generated_nodes
+                        << " " << run.seconds << "s" << std::endl;
+            }
+          }
+        }
+      }
+
+      write_table( std::cout, runs );
+      std::ofstream fout( csv_file );
+      if( !fout ) {
+        std::cerr << "Unable to open " << csv_file << "." << std::endl;
+        return 1;
+      }
+      write_csv( fout, corpus, runs );
+      std::cout << "Wrote " << runs.size( ) << " runs to " << csv_file << "." << std::endl;
+      return 0;
+    }
+
+  }
+}
+
+int main( int argc, char **argv ) {
+  return cgl::rubiks::bench_e2e_main( argc, argv );
+}
@@ -0,0 +1,488 @@
+#include "cglRubiksCube.h"
+#include "cglRubiksState.h"
+#include "cglRubiksProblem.h"
+#include "cglRubiksRandom.h"
+#include "cglRubiksRandomCube.h"
+#include "ai_search.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*********************************************
+     * Benchmark harness
+     */
+
+    /* each benchmark stores a sum of its results here, so the compiler
+     * can not drop the work
+     */
+    static volatile std::uint64_t bench_sink = 0;
+
+    struct BenchConfig {
+      unsigned int repetitions;     // timed samples per benchmark
+      unsigned int warmups;         // untimed samples per benchmark
+      double       min_sample_ms;   // iterations are doubled until a sample takes this long
+      std::string  filter;          // only benchmarks whose name contains this
+      std::string  output;          // JSON file, "" for standard output
+      bool         list;
+      bool         perf;            // count hardware events of the timed samples
+    };
+
+    struct Benchmark {
+      std::string name;
+      size_t      ops_per_iteration;
+      /* runs the benchmark body iterations times */
+      std::function< void( size_t ) > run;
+    };
+
+    struct BenchResult {
+      std::string         name;
+      size_t              iterations;
+      size_t              ops_per_iteration;
+      std::vector< double > ns_per_op; // one per sample, sorted
+      std::uint64_t       events[ ai::Search::PerfCounters::E_MAX ]; // summed over the timed samples
+    };
+
+    /* counters, if not null, add the sample's events to events */
+    static double run_sample( const Benchmark& benchmark, const size_t iterations,
+                              const ai::Search::PerfCounters *counters = 0, std::uint64_t *events = 0 ) {
+      std::uint64_t events_start[ ai::Search::PerfCounters::E_MAX ];
+      if( counters ) {
+        counters->Read( events_start );
+      }
+      auto start = std::chrono::steady_clock::now( );
+      benchmark.run( iterations );
+      std::chrono::duration< double, std::nano > ns = std::chrono::steady_clock::now( ) - start;
+      if( counters ) {
+        std::uint64_t events_end[ ai::Search::PerfCounters::E_MAX ];
+        counters->Read( events_end );
+        int e;
+        for( e = 0; e < ai::Search::PerfCounters::E_MAX; e++ ) {
+          events[ e ] += events_end[ e ] - events_start[ e ];
+        }
+      }
+      return ns.count( );
+    }
+
+    /* counters is null when events are not counted */
+    static BenchResult run_benchmark( const Benchmark& benchmark, const BenchConfig& config, const ai::Search::PerfCounters *counters ) {
+      BenchResult result;
+      result.name = benchmark.name;
+      result.ops_per_iteration = benchmark.ops_per_iteration;
+      std::fill( result.events, result.events + ai::Search::PerfCounters::E_MAX, 0 );
+
+      size_t iterations = 1;
+      while( run_sample( benchmark, iterations ) < config.min_sample_ms * 1e6 && iterations < ( 1u << 30 ) ) {
+        iterations *= 2;
+      }
+      result.iterations = iterations;
+
+      unsigned int i;
+      for( i = 0; i < config.warmups; i++ ) {
+        run_sample( benchmark, iterations );
+      }
+      for( i = 0; i < config.repetitions; i++ ) {
+        double ns = run_sample( benchmark, iterations, counters, result.events );
+        result.ns_per_op.push_back( ns / ( iterations * benchmark.ops_per_iteration ) );
+      }
+      std::sort( result.ns_per_op.begin( ), result.ns_per_op.end( ) );
+      return result;
+    }
+
+    /* nearest rank percentile of sorted values */
+    static double percentile( const std::vector< double >& sorted, const double p ) {
+      if( sorted.empty( ) ) {
+        return 0.0;
+      }
+      size_t rank = static_cast< size_t >( p / 100.0 * ( sorted.size( ) - 1 ) + 0.5 );
+      return sorted[ std::min( rank, sorted.size( ) - 1 ) ];
+    }
+
+    static std::string json_string( const std::string& s ) {
+      std::string quoted = "\"";
+      for( auto it = s.begin( ); it != s.end( ); it++ ) {
+        if( *it == '"' || *it == '\\' ) {
+          quoted += '\\';
+        }
+        quoted += *it;
+      }
+      return quoted + "\"";
+    }
+
+    /* events per operation of the timed samples */
+    static double events_per_op( const BenchResult& result, const BenchConfig& config, const ai::Search::PerfCounters::EventType event ) {
+      return static_cast< double >( result.events[ event ] ) / ( result.iterations * result.ops_per_iteration * config.repetitions );
+    }
+
+    static void write_json( std::ostream& os, const BenchConfig& config, const ai::Search::PerfCounters& counters,
+                            const std::vector< BenchResult >& results ) {
+      os << "{" << std::endl;
+      os << "  \"context\": {" << std::endl;
+      os << "    \"compiler\": " << json_string( __VERSION__ ) << "," << std::endl;
+      os << "    \"hardware_threads\": " << std::thread::hardware_concurrency( ) << "," << std::endl;
+      os << "    \"repetitions\": " << config.repetitions << "," << std::endl;
+      os << "    \"warmups\": " << config.warmups << "," << std::endl;
+      os << "    \"min_sample_ms\": " << config.min_sample_ms << "," << std::endl;
+      os << "    \"perf_counters\": " << json_string( !config.perf ? "disabled" : counters.IsOpen( ) ? "enabled" : "unavailable: " + counters.GetError( ) ) << std::endl;
+      os << "  }," << std::endl;
+      os << "  \"benchmarks\": [" << std::endl;
+      for( auto it = results.begin( ); it != results.end( ); it++ ) {
+        const std::vector< double >& ns = it->ns_per_op;
+        os << "    { \"name\": " << json_string( it->name )
+           << ", \"iterations\": " << it->iterations
+           << ", \"ops_per_iteration\": " << it->ops_per_iteration
+           << ", \"samples\": " << ns.size( )
+           << ", \"ns_per_op\": { \"median\": " << percentile( ns, 50 )
+           << ", \"p10\": " << percentile( ns, 10 )
+           << ", \"p90\": " << percentile( ns, 90 )
+           << ", \"min\": " << ( ns.empty( ) ? 0.0 : ns.front( ) )
+           << ", \"max\": " << ( ns.empty( ) ? 0.0 : ns.back( ) ) << " }";
+        if( config.perf && counters.IsOpen( ) ) {
+          os << ", \"events_per_op\": {";
+          const char *separator = " ";
+          int e;
+          for( e = 0; e < ai::Search::PerfCounters::E_MAX; e++ ) {
+            const ai::Search::PerfCounters::EventType event = static_cast< ai::Search::PerfCounters::EventType >( e );
+            if( counters.IsAvailable( event ) ) {
+              os << separator << "\"" << ai::Search::PerfCounters::EventName( event ) << "\": " << events_per_op( *it, config, event );
+              separator = ", ";
+            }
+          }
+          os << " }";
+        }
+        os << " }";
+        if( it + 1 != results.end( ) ) {
+          os << ",";
+        }
+        os << std::endl;
+      }
+      os << "  ]" << std::endl;
+      os << "}" << std::endl;
+    }
+
+    /*
+     * Benchmark harness
+     *********************************************/
+
+    /*********************************************
+     * Benchmarks
+     */
+
+    /* Shared inputs, built once.  The seed is fixed so runs time the
+     * same cubes.
+     */
+    struct BenchData {
+      std::vector< Move > moves;
+      std::vector< Cube > cubes;       // uniformly random cubes
+      std::vector< Cube > cube_copies; // equal to cubes, different storage
+      std::vector< std::unique_ptr< State > > states;
+    };
+
+    static const size_t NUM_CUBES = 1024;
+    static const size_t CUBE_MASK = NUM_CUBES - 1;
+
+    static void build_bench_data( BenchData& data ) {
+      const Move::BasicMove basic[ 12 ] = { Move::M_U, Move::M_UP, Move::M_L, Move::M_LP, Move::M_F, Move::M_FP,
+                                            Move::M_R, Move::M_RP, Move::M_B, Move::M_BP, Move::M_D, Move::M_DP };
+      for( const Move::BasicMove& m : basic ) {
+        data.moves.push_back( Move( m ) );
+      }
+      RandomCubeSampler sampler( 1 );
+      Cube solved;
+      std::string facelets;
+      size_t i;
+      for( i = 0; i < NUM_CUBES; i++ ) {
+        sampler.sample( solved, facelets );
+        data.cubes.push_back( Cube( ) );
+        data.cubes.back( ).assignFromString( facelets );
+      }
+      data.cube_copies = data.cubes;
+      for( i = 0; i < NUM_CUBES; i++ ) {
+        data.states.push_back( std::unique_ptr< State >( new State( data.cubes[ i ] ) ) );
+      }
+    }
+
+    static void add_cube_benchmarks( std::vector< Benchmark >& benchmarks, const BenchData& data ) {
+      benchmarks.push_back( { "cube/applyMove", 1, [ &data ]( size_t n ) {
+            std::uint64_t sum = 0;
+            Cube result;
+            size_t i;
+            for( i = 0; i < n; i++ ) {
+              result.applyMove( data.moves[ i % data.moves.size( ) ], data.cubes[ i & CUBE_MASK ] );
+              sum += result.getFacelets( )[ 0 ];
+            }
+            bench_sink = sum;
+          } } );
+      benchmarks.push_back( { "cube/unapplyMove", 1, [ &data ]( size_t n ) {
+            std::uint64_t sum = 0;
+            Cube result;
+            size_t i;
+            for( i = 0; i < n; i++ ) {
+              result.unapplyMove( data.moves[ i % data.moves.size( ) ], data.cubes[ i & CUBE_MASK ] );
+              sum += result.getFacelets( )[ 0 ];
+            }
+            bench_sink = sum;
+          } } );
+      benchmarks.push_back( { "move/compose", 1, [ &data ]( size_t n ) {
+            std::uint64_t sum = 0;
+            Move result;
+            size_t i;
+            for( i = 0; i < n; i++ ) {
+              result.compose( data.moves[ i % data.moves.size( ) ], data.moves[ ( i / 12 ) % data.moves.size( ) ] );
+              sum += result.getTransform( )[ 0 ];
+            }
+            bench_sink = sum;
+          } } );
+      benchmarks.push_back( { "cube/operator==/different", 1, [ &data ]( size_t n ) {
+            std::uint64_t sum = 0;
+            size_t i;
+            for( i = 0; i < n; i++ ) {
+              sum += data.cubes[ i & CUBE_MASK ] == data.cubes[ ( i + 1 ) & CUBE_MASK ];
+            }
+            bench_sink = sum;
+          } } );
+      benchmarks.push_back( { "cube/operator==/equal", 1, [ &data ]( size_t n ) {
+            std::uint64_t sum = 0;
+            size_t i;
+            for( i = 0; i < n; i++ ) {
+              sum += data.cubes[ i & CUBE_MASK ] == data.cube_copies[ i & CUBE_MASK ];
+            }
+            bench_sink = sum;
+          } } );
+      benchmarks.push_back( { "cube/operator</different", 1, [ &data ]( size_t n ) {
+            std::uint64_t sum = 0;
+            size_t i;
+            for( i = 0; i < n; i++ ) {
+              sum += data.cubes[ i & CUBE_MASK ] < data.cubes[ ( i + 1 ) & CUBE_MASK ];
+            }
+            bench_sink = sum;
+          } } );
+      benchmarks.push_back( { "cube/operator</equal", 1, [ &data ]( size_t n ) {
+            std::uint64_t sum = 0;
+            size_t i;
+            for( i = 0; i < n; i++ ) {
+              sum += data.cubes[ i & CUBE_MASK ] < data.cube_copies[ i & CUBE_MASK ];
+            }
+            bench_sink = sum;
+          } } );
+    }
+
+    static void add_heuristic_benchmarks( std::vector< Benchmark >& benchmarks, const BenchData& data ) {
+      const std::vector< std::pair< std::string, Problem::HeuristicEnum > > heuristics = {
+        { "zero", Problem::ZERO_HEURISTIC },
+        { "facelet", Problem::FACELET_HEURISTIC },
+        { "edge_facelet", Problem::EDGE_FACELET_HEURISTIC },
+        { "corner_facelet", Problem::CORNER_FACELET_HEURISTIC },
+        { "facelet_max", Problem::FACELET_MAX_HEURISTIC },
+        { "color_count", Problem::COLOR_COUNT_HEURISTIC }
+      };
+      for( auto it = heuristics.begin( ); it != heuristics.end( ); it++ ) {
+        const Problem::HeuristicEnum heuristic = it->second;
+        benchmarks.push_back( { "heuristic/" + it->first, 1, [ &data, heuristic ]( size_t n ) {
+              State initial{ Cube( ) };
+              Problem problem( &initial, std::vector< Cube >( 1, Cube( ) ) );
+              problem.setHeuristic( heuristic );
+              double sum = 0.0;
+              size_t i;
+              for( i = 0; i < n; i++ ) {
+                sum += problem.Heuristic( data.states[ i & CUBE_MASK ].get( ) );
+              }
+              bench_sink = static_cast< std::uint64_t >( sum );
+            } } );
+      }
+    }
+
+    /* nodes for size distinct states, with random costs for the priority frontiers */
+    static std::vector< ai::Search::Node * > make_nodes( const size_t size ) {
+      std::vector< ai::Search::Node * > nodes;
+      RandomCubeSampler sampler( size );
+      Random random( size );
+      Cube solved;
+      Cube cube;
+      std::string facelets;
+      size_t i;
+      for( i = 0; i < size; i++ ) {
+        sampler.sample( solved, facelets );
+        cube.assignFromString( facelets );
+        nodes.push_back( new ai::Search::Node( new State( cube ), 0, 0, random.below( 20 ), random.below( 20 ) / 20.0, 0 ) );
+      }
+      return nodes;
+    }
+
+    static const std::vector< size_t > CONTAINER_SIZES = { 1000, 10000, 100000 };
+
+    static void add_closed_list_benchmarks( std::vector< Benchmark >& benchmarks, std::vector< std::shared_ptr< std::vector< ai::Search::Node * > > >& node_sets ) {
+      for( auto size = CONTAINER_SIZES.begin( ); size != CONTAINER_SIZES.end( ); size++ ) {
+        std::shared_ptr< std::vector< ai::Search::Node * > > nodes( new std::vector< ai::Search::Node * >( make_nodes( *size ) ) );
+        node_sets.push_back( nodes );
+        benchmarks.push_back( { "closed_list/Insert/" + std::to_string( *size ), *size, [ nodes ]( size_t n ) {
+              std::uint64_t sum = 0;
+              ai::Search::ClosedList closed;
+              size_t i;
+              for( i = 0; i < n; i++ ) {
+                closed.Clear( );
+                for( auto it = nodes->begin( ); it != nodes->end( ); it++ ) {
+                  sum += closed.Insert( *it );
+                }
+              }
+              bench_sink = sum;
+            } } );
+        /* half the lookups hit, half miss */
+        std::shared_ptr< ai::Search::ClosedList > closed( new ai::Search::ClosedList( ) );
+        size_t i;
+        for( i = 0; i < nodes->size( ); i += 2 ) {
+          closed->Insert( ( *nodes )[ i ] );
+        }
+        benchmarks.push_back( { "closed_list/Contains/" + std::to_string( *size / 2 ), *size, [ nodes, closed ]( size_t n ) {
+              std::uint64_t sum = 0;
+              size_t i;
+              for( i = 0; i < n; i++ ) {
+                for( auto it = nodes->begin( ); it != nodes->end( ); it++ ) {
+                  sum += closed->Contains( *it );
+                }
+              }
+              bench_sink = sum;
+            } } );
+      }
+    }
+
+    static void add_frontier_benchmarks( std::vector< Benchmark >& benchmarks, std::vector< std::shared_ptr< std::vector< ai::Search::Node * > > >& node_sets ) {
+      typedef std::function< ai::Search::Frontier *( ) > FrontierFactory;
+      const std::vector< std::pair< std::string, FrontierFactory > > frontiers = {
+        { "BFFrontier", [ ]( ) { return new ai::Search::BFFrontier( ); } },
+        { "DFFrontier", [ ]( ) { return new ai::Search::DFFrontier( ); } },
+        { "DLFrontier", [ ]( ) { return new ai::Search::DLFrontier( 1000 ); } },
+        { "BFLimitedFrontier", [ ]( ) { return new ai::Search::BFLimitedFrontier( 1000 ); } },
+        { "UCFrontier", [ ]( ) { return new ai::Search::UCFrontier( ); } },
+        { "GreedyFrontier", [ ]( ) { return new ai::Search::GreedyFrontier( ); } },
+        { "AStarFrontier", [ ]( ) { return new ai::Search::AStarFrontier( ); } },
+        { "AStarLimitedFrontier", [ ]( ) { return new ai::Search::AStarLimitedFrontier( 1000.0 ); } }
+      };
+      for( auto size = CONTAINER_SIZES.begin( ); size != CONTAINER_SIZES.end( ); size++ ) {
+        std::shared_ptr< std::vector< ai::Search::Node * > > nodes( new std::vector< ai::Search::Node * >( make_nodes( *size ) ) );
+        node_sets.push_back( nodes );
+        for( auto it = frontiers.begin( ); it != frontiers.end( ); it++ ) {
+          const FrontierFactory factory = it->second;
+          /* each node is inserted and removed once, 2 operations */
+          benchmarks.push_back( { "frontier/" + it->first + "/InsertRemove/" + std::to_string( *size ), 2 * *size, [ nodes, factory ]( size_t n ) {
+                std::uint64_t sum = 0;
+                std::unique_ptr< ai::Search::Frontier > frontier( factory( ) );
+                size_t i;
+                for( i = 0; i < n; i++ ) {
+                  for( auto node = nodes->begin( ); node != nodes->end( ); node++ ) {
+                    frontier->Insert( *node );
+                  }
+                  while( !frontier->Empty( ) ) {
+                    sum += frontier->Remove( )->GetDepth( );
+                  }
+                }
+                bench_sink = sum;
+              } } );
+        }
+      }
+    }
+
+    /*
+     * Benchmarks
+     *********************************************/
+
+    static int usage( const char *program ) {
+      std::cerr << "usage: " << program << " [--filter text] [--repetitions n] [--warmups n] [--min-sample-ms ms] [--output file] [--list] [--perf]" << std::endl;
+      return 1;
+    }
+
+    static int bench_main( int argc, char **argv ) {
+      BenchConfig config = { 15, 1, 10.0, "", "", false, false };
+      int i;
+      for( i = 1; i < argc; i++ ) {
+        std::string arg = argv[ i ];
+        if( arg == "--list" ) {
+          config.list = true;
+        } else if( arg == "--perf" ) {
+          config.perf = true;
+        } else if( i + 1 < argc && arg == "--filter" ) {
+          config.filter = argv[ ++i ];
+        } else if( i + 1 < argc && arg == "--repetitions" ) {
+          config.repetitions = std::max( 1, std::atoi( argv[ ++i ] ) );
+        } else if( i + 1 < argc && arg == "--warmups" ) {
+          config.warmups = std::max( 0, std::atoi( argv[ ++i ] ) );
+        } else if( i + 1 < argc && arg == "--min-sample-ms" ) {
+          config.min_sample_ms = std::atof( argv[ ++i ] );
+        } else if( i + 1 < argc && arg == "--output" ) {
+          config.output = argv[ ++i ];
+        } else {
+          return usage( argv[ 0 ] );
+        }
+      }
+
+      BenchData data;
+      build_bench_data( data );
+      std::vector< std::shared_ptr< std::vector< ai::Search::Node * > > > node_sets;
+      std::vector< Benchmark > benchmarks;
+      add_cube_benchmarks( benchmarks, data );
+      add_heuristic_benchmarks( benchmarks, data );
+      add_closed_list_benchmarks( benchmarks, node_sets );
+      add_frontier_benchmarks( benchmarks, node_sets );
+
+      /* the benchmarks run on this thread, which the counters count */
+      ai::Search::PerfCounters counters;
+      if( config.perf && !config.list && !counters.Open( ) ) {
+        std::cerr << "Hardware counters unavailable, timing only: " << counters.GetError( ) << std::endl;
+      }
+
+      std::vector< BenchResult > results;
+      for( auto it = benchmarks.begin( ); it != benchmarks.end( ); it++ ) {
+        if( it->name.find( config.filter ) == std::string::npos ) {
+          continue;
+        }
+        if( config.list ) {
+          std::cout << it->name << std::endl;
+          continue;
+        }
+        results.push_back( run_benchmark( *it, config, counters.IsOpen( ) ? &counters : 0 ) );
+        std::cerr << it->name << " " << percentile( results.back( ).ns_per_op, 50 ) << " ns/op";
+        if( counters.IsAvailable( ai::Search::PerfCounters::E_CYCLES ) ) {
+          std::cerr << " " << events_per_op( results.back( ), config, ai::Search::PerfCounters::E_CYCLES ) << " cycles/op";
+        }
+        std::cerr << std::endl;
+      }
+
+      for( auto set = node_sets.begin( ); set != node_sets.end( ); set++ ) {
+        for( auto it = ( *set )->begin( ); it != ( *set )->end( ); it++ ) {
+          delete *it;
+        }
+      }
+      if( config.list ) {
+        return 0;
+      }
+
+      if( config.output.empty( ) ) {
+        write_json( std::cout, config, counters, results );
+      } else {
+        std::ofstream fout( config.output );
+        if( !fout ) {
+          std::cerr << "Unable to open " << config.output << "." << std::endl;
+          return 1;
+        }
+        write_json( fout, config, counters, results );
+      }
+      return 0;
+    }
+
+  }
+}
+
+int main( int argc, char **argv ) {
+  return cgl::rubiks::bench_main( argc, argv );
+}
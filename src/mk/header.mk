@@ -1,19 +1,20 @@
 CXX := g++
 AR := ar
-CXXFLAGS := -Wall -Wextra -Wpedantic -Werror -std=c++20
+CXXFLAGS := -Wall -Wextra -Wpedantic -Werror -std=c++20 -pthread
 ARFLAGS := crus
 DEPDIR := .d
 DEPFLAGS = -MT $@ -MMD -MP -MF $(DEPDIR)/$*.d
 
 SOURCES := $(wildcard *.cpp)
 OBJECTS := $(patsubst %.cpp,%.o,$(SOURCES))
+DEPS := $(patsubst %.cpp,$(DEPDIR)/%.d,$(SOURCES))
 
 AI_INCLUDE := $(PROJECT_ROOT)/src/ai-lib/include
 AI_LIB_DIR := $(PROJECT_ROOT)/src/ai-lib/lib
 AI_LIB     := $(AI_LIB_DIR)/libai.a
 CXXFLAGS += -I$(AI_INCLUDE)
 
-LDFLAGS := -L $(AI_LIB_DIR) -lai
+LDFLAGS := -L $(AI_LIB_DIR) -lai -pthread
 BIN_DIR := $(PROJECT_ROOT)/bin
 
 .PRECIOUS: $(DEPDIR)/%.d
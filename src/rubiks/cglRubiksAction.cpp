@@ -14,6 +14,12 @@ namespace cgl {
       std::cout << mMove.getName( ) << std::endl;
     }
     
+    size_t Action::MemoryBytes( ) const {
+      return ai::Search::HeapBlockBytes( sizeof( Action ) )
+        + ai::Search::VectorHeapBytes( mMove.getTransform( ) )
+        + ai::Search::StringHeapBytes( mMove.getName( ) );
+    }
+
     const Move& Action::getMove( ) const {
       return mMove;
     }
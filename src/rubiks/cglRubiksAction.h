@@ -13,6 +13,7 @@ namespace cgl {
       Action( const Move& move );
       virtual ~Action( );
       virtual void Display( ) const;
+      virtual size_t MemoryBytes( ) const;
       
       const Move& getMove( ) const;
       
@@ -1,10 +1,16 @@
 #include "cglRubiksProblem.h"
 #include "cglRubiksAppConfig.h"
+#include "cglRubiksTokenizer.h"
 #include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
 
 namespace cgl {
   namespace rubiks {
 
+    static const double MAX_SEED = 9007199254740992.0;
+
     AppConfig::AppConfig( ) {
       /* Initialize configuration parameters */
       mOptions[ "enable_prompt" ] = 1;
@@ -23,6 +29,17 @@ namespace cgl {
       mOptions[ "solution_display" ] = 0;
       mOptions[ "initial_cube_remove_wildcard" ] = 0;
       mOptions[ "compile_preconditions" ] = 1;
+      mOptions[ "threads" ] = 0;
+      mOptions[ "seed" ] = 0;
+      mOptions[ "solution_cache" ] = 0;
+      mOptions[ "cache_capacity" ] = 100000;
+      mOptions[ "machine_stats" ] = 0;
+      mOptions[ "progress_interval" ] = 0;
+      mOptions[ "memory_limit" ] = 0;
+      mOptions[ "trace_sample_interval" ] = 1;
+      mOptions[ "auto_time_limit" ] = 60;
+      mOptions[ "perf_counters" ] = 0;
+      mOptions[ "alloc_profile" ] = 0;
 
       // Populate mOptionStringToValues and mOptionValueToStrings
       // Boolean options
@@ -51,6 +68,24 @@ namespace cgl {
       mOptionValueToStrings["initial_cube_remove_wildcard"][1.0] = "enabled";
       mOptionValueToStrings["initial_cube_remove_wildcard"][0.0] = "disabled";
 
+      mOptionStringToValues["solution_cache"]["enable"] = 1.0;
+      mOptionStringToValues["solution_cache"]["disable"] = 0.0;
+      mOptionValueToStrings["solution_cache"][1.0] = "enabled";
+      mOptionValueToStrings["solution_cache"][0.0] = "disabled";
+
+      mOptionStringToValues["machine_stats"]["enable"] = 1.0;
+      mOptionStringToValues["machine_stats"]["disable"] = 0.0;
+      mOptionValueToStrings["machine_stats"][1.0] = "enabled";
+      mOptionValueToStrings["machine_stats"][0.0] = "disabled";
+      mOptionStringToValues["perf_counters"]["enable"] = 1.0;
+      mOptionStringToValues["perf_counters"]["disable"] = 0.0;
+      mOptionValueToStrings["perf_counters"][1.0] = "enabled";
+      mOptionValueToStrings["perf_counters"][0.0] = "disabled";
+      mOptionStringToValues["alloc_profile"]["enable"] = 1.0;
+      mOptionStringToValues["alloc_profile"]["disable"] = 0.0;
+      mOptionValueToStrings["alloc_profile"][1.0] = "enabled";
+      mOptionValueToStrings["alloc_profile"][0.0] = "disabled";
+
       mOptionStringToValues["compile_preconditions"]["enable"] = 1.0;
       mOptionStringToValues["compile_preconditions"]["disable"] = 0.0;
       mOptionValueToStrings["compile_preconditions"][1.0] = "enabled";
@@ -75,12 +110,21 @@ namespace cgl {
       mOptionStringToValues["heuristic"]["corner_facelet"] = Problem::CORNER_FACELET_HEURISTIC;
       mOptionStringToValues["heuristic"]["facelet_max"] = Problem::FACELET_MAX_HEURISTIC;
       mOptionStringToValues["heuristic"]["color_count"] = Problem::COLOR_COUNT_HEURISTIC;
+      mOptionStringToValues["heuristic"]["plan_facelet"] = Problem::PLAN_FACELET_HEURISTIC;
+      mOptionStringToValues["heuristic"]["plan_distance"] = Problem::PLAN_DISTANCE_HEURISTIC;
       mOptionValueToStrings["heuristic"][Problem::ZERO_HEURISTIC] = "zero";
       mOptionValueToStrings["heuristic"][Problem::FACELET_HEURISTIC] = "facelet";
       mOptionValueToStrings["heuristic"][Problem::EDGE_FACELET_HEURISTIC] = "edge_facelet";
       mOptionValueToStrings["heuristic"][Problem::CORNER_FACELET_HEURISTIC] = "corner_facelet";
       mOptionValueToStrings["heuristic"][Problem::FACELET_MAX_HEURISTIC] = "facelet_max";
       mOptionValueToStrings["heuristic"][Problem::COLOR_COUNT_HEURISTIC] = "color_count";
+      mOptionValueToStrings["heuristic"][Problem::PLAN_FACELET_HEURISTIC] = "plan_facelet";
+      mOptionValueToStrings["heuristic"][Problem::PLAN_DISTANCE_HEURISTIC] = "plan_distance";
+
+      // Numeric options with limits
+      mOptionRanges["threads"] = std::make_pair( 0.0, 1024.0 );
+      // seeds are kept as doubles, which hold integers exactly up to 2^53
+      mOptionRanges["seed"] = std::make_pair( 0.0, MAX_SEED );
 
       mOptionStringToValues["solution_display"]["human"] = 0.0;
       mOptionStringToValues["solution_display"]["machine"] = 1.0;
@@ -103,12 +147,15 @@ namespace cgl {
           }
         } else {
           // No string mappings, try to convert to double
-          std::stringstream ss( value );
           double number;
-          ss >> number;
-          if (ss.fail()) {
+          if ( !parse_number( value, number ) ) {
             return false; // Could not convert to double
           }
+          auto it_range = mOptionRanges.find(option);
+          if ( it_range != mOptionRanges.end() &&
+               !( number >= it_range->second.first && number <= it_range->second.second ) ) {
+            return false; // Out of range
+          }
           mOptions[ option ] = number;
           return true;
         }
@@ -145,13 +192,18 @@ namespace cgl {
         }
       } else {
         // No string mappings, try to convert to double
-        std::stringstream ss( value );
         double number;
-        ss >> number;
-        if (ss.fail()) {
+        if ( !parse_number( value, number ) ) {
           ss_error << "Invalid value '" << value << "' for option '" << option << "'. Expected a numeric value.";
           return ss_error.str();
         }
+        auto it_range = mOptionRanges.find(option);
+        if ( it_range != mOptionRanges.end() &&
+             !( number >= it_range->second.first && number <= it_range->second.second ) ) {
+          ss_error << "Invalid value '" << value << "' for option '" << option << "'. ";
+          ss_error << std::setprecision( 17 ) << "Expected a value from " << it_range->second.first << " to " << it_range->second.second << ".";
+          return ss_error.str();
+        }
       }
       return ""; // Should not reach here if updateOption returned false
     }
@@ -290,6 +342,64 @@ namespace cgl {
     void AppConfig::setGenerationLimit( const double limit ) {
       mOptions[ "generation_limit" ] = limit;
     }
+    double AppConfig::memoryLimit( ) const {
+      return mOptions.at( "memory_limit" );
+    }
+    void AppConfig::setMemoryLimit( const double megabytes ) {
+      mOptions[ "memory_limit" ] = megabytes;
+    }
+    void AppConfig::enableSolutionCache( ) {
+      mOptions[ "solution_cache" ] = 1;
+    }
+    void AppConfig::disableSolutionCache( ) {
+      mOptions[ "solution_cache" ] = 0;
+    }
+    bool AppConfig::solutionCache( ) const {
+      return static_cast< int >( mOptions.at( "solution_cache" ) ) == 1;
+    }
+    double AppConfig::cacheCapacity( ) const {
+      return mOptions.at( "cache_capacity" );
+    }
+    void AppConfig::setCacheCapacity( const double capacity ) {
+      mOptions[ "cache_capacity" ] = capacity;
+    }
+    std::uint64_t AppConfig::seed( ) const {
+      return static_cast< std::uint64_t >( mOptions.at( "seed" ) );
+    }
+    void AppConfig::setSeed( const std::uint64_t seed ) {
+      mOptions[ "seed" ] = std::min( static_cast< double >( seed ), MAX_SEED );
+    }
+    double AppConfig::progressInterval( ) const {
+      return mOptions.at( "progress_interval" );
+    }
+    void AppConfig::setProgressInterval( const double seconds ) {
+      mOptions[ "progress_interval" ] = seconds;
+    }
+    double AppConfig::autoTimeLimit( ) const {
+      return mOptions.at( "auto_time_limit" );
+    }
+    void AppConfig::setAutoTimeLimit( const double seconds ) {
+      mOptions[ "auto_time_limit" ] = seconds;
+    }
+    int AppConfig::traceSampleInterval( ) const {
+      return static_cast< int >( mOptions.at( "trace_sample_interval" ) );
+    }
+    void AppConfig::setTraceSampleInterval( const int interval ) {
+      mOptions[ "trace_sample_interval" ] = interval;
+    }
+    int AppConfig::threads( ) const {
+      return static_cast< int >( mOptions.at( "threads" ) );
+    }
+    void AppConfig::setThreads( const int threads ) {
+      mOptions[ "threads" ] = threads;
+    }
+    unsigned int AppConfig::workerThreads( ) const {
+      int configured = threads( );
+      if( configured > 0 ) {
+        return configured;
+      }
+      return std::max( 1u, std::thread::hardware_concurrency( ) );
+    }
     double AppConfig::storageLimit( ) const {
       return mOptions.at( "storage_limit" );
     }
@@ -325,6 +435,12 @@ namespace cgl {
     void AppConfig::setColorCountHeuristic( ) {
       mOptions[ "heuristic" ] = Problem::COLOR_COUNT_HEURISTIC;
     }
+    void AppConfig::setPlanFaceletHeuristic( ) {
+      mOptions[ "heuristic" ] = Problem::PLAN_FACELET_HEURISTIC;
+    }
+    void AppConfig::setPlanDistanceHeuristic( ) {
+      mOptions[ "heuristic" ] = Problem::PLAN_DISTANCE_HEURISTIC;
+    }
     int AppConfig::heuristic( ) const {
       return static_cast< int >( mOptions.at( "heuristic" ) );
     }
@@ -343,6 +459,33 @@ namespace cgl {
     bool AppConfig::displaySolutionMachine( ) const {
       return static_cast< int >( mOptions.at( "solution_display" ) ) == 1;
     }
+    void AppConfig::enableMachineStats( ) {
+      mOptions[ "machine_stats" ] = 1;
+    }
+    void AppConfig::disableMachineStats( ) {
+      mOptions[ "machine_stats" ] = 0;
+    }
+    bool AppConfig::machineStats( ) const {
+      return static_cast< int >( mOptions.at( "machine_stats" ) ) == 1;
+    }
+    void AppConfig::enablePerfCounters( ) {
+      mOptions[ "perf_counters" ] = 1;
+    }
+    void AppConfig::disablePerfCounters( ) {
+      mOptions[ "perf_counters" ] = 0;
+    }
+    bool AppConfig::perfCounters( ) const {
+      return static_cast< int >( mOptions.at( "perf_counters" ) ) == 1;
+    }
+    void AppConfig::enableAllocProfile( ) {
+      mOptions[ "alloc_profile" ] = 1;
+    }
+    void AppConfig::disableAllocProfile( ) {
+      mOptions[ "alloc_profile" ] = 0;
+    }
+    bool AppConfig::allocProfile( ) const {
+      return static_cast< int >( mOptions.at( "alloc_profile" ) ) == 1;
+    }
 
     // auto transform starting cube's *s to xs
     void AppConfig::enableInitialCubeAutoRemoveWildcard( ) {
@@ -1,6 +1,7 @@
 #ifndef _CGLRUBIKSAPPCONFIG_H_
 #define _CGLRUBIKSAPPCONFIG_H_
 
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <map>
@@ -57,6 +58,39 @@ namespace cgl {
       void setGenerationLimit( const double limit );
       double storageLimit( ) const;
       void setStorageLimit( const double limit );
+      // MB of nodes, states, actions, frontier and closed list, 0 for no limit
+      double memoryLimit( ) const;
+      void setMemoryLimit( const double megabytes );
+
+      // seconds between search progress lines on stderr, 0 for none
+      double progressInterval( ) const;
+      void setProgressInterval( const double seconds );
+
+      // seconds a search chosen by auto may take, see search auto
+      double autoTimeLimit( ) const;
+      void setAutoTimeLimit( const double seconds );
+
+      // record every n'th expansion to the trace file, see the trace command
+      int traceSampleInterval( ) const;
+      void setTraceSampleInterval( const int interval );
+
+      // worker threads for batch, generate and profile_heuristic,
+      // 0 for one per hardware thread
+      int threads( ) const;
+      void setThreads( const int threads );
+      // threads( ), or the hardware threads if it is 0, and at least 1
+      unsigned int workerThreads( ) const;
+
+      // seed for all random choices, 0 for a seed from the clock, at most 2^53
+      std::uint64_t seed( ) const;
+      void setSeed( const std::uint64_t seed );
+
+      // solution cache in front of search and plan
+      void enableSolutionCache( );
+      void disableSolutionCache( );
+      bool solutionCache( ) const;
+      double cacheCapacity( ) const;
+      void setCacheCapacity( const double capacity );
 
       void enableApplySolution( );
       void disableApplySolution( );
@@ -69,6 +103,8 @@ namespace cgl {
       void setCornerFaceletHeuristic( );
       void setFaceletMaxHeuristic( );
       void setColorCountHeuristic( );
+      void setPlanFaceletHeuristic( );
+      void setPlanDistanceHeuristic( );
       int heuristic( ) const;
 
       // how to display search results
@@ -76,6 +112,18 @@ namespace cgl {
       void setDisplaySolutionMachine( );
       bool displaySolutionHuman( ) const;
       bool displaySolutionMachine( ) const;
+      // append search statistics to machine readable results
+      void enableMachineStats( );
+      void disableMachineStats( );
+      bool machineStats( ) const;
+      // count hardware events in search statistics
+      void enablePerfCounters( );
+      void disablePerfCounters( );
+      bool perfCounters( ) const;
+      // count heap allocations in search statistics
+      void enableAllocProfile( );
+      void disableAllocProfile( );
+      bool allocProfile( ) const;
 
       // auto transform starting cube's *s to xs
       void enableInitialCubeAutoRemoveWildcard( );
@@ -96,6 +144,8 @@ namespace cgl {
     private:
       std::map<std::string, std::map<std::string, double>> mOptionStringToValues;
       std::map<std::string, std::map<double, std::string>> mOptionValueToStrings;
+      // inclusive limits of numeric options that have them
+      std::map<std::string, std::pair<double, double>> mOptionRanges;
     };
 
   }
@@ -1,5 +1,6 @@
 #include "cglRubiksAppData.h"
 #include "cglRubiksCommand.h"
+#include <sstream>
 
 namespace cgl {
   namespace rubiks {
@@ -8,14 +9,91 @@ namespace cgl {
       : goal_cubes( 1 ), 
         is( is_in ),
         os( os_in ),
+        move_set( std::make_shared< MoveSet >( ) ),
+        cube_set( std::make_shared< CubeSet >( ) ),
         done( false ),
+        plan_action_set( std::make_shared< PlanActionSet >( ) ),
+        solution_cache( std::make_shared< SolutionCache >( ) ),
+        owns_solution_cache( true ),
+        state_table( std::make_shared< StateTable >( ) ),
         solution_valid( false ),
         solution( "" ) {
       goal_cubes[ 0 ].assignSolved( );
       setLegalMoves( );
+      seedRandom( );
+    }
+
+    void AppData::copyState( const AppData& rhs ) {
+      config = rhs.config;
+      cube = rhs.cube;
+      goal_cubes = rhs.goal_cubes;
+      actions = rhs.actions;
+      move_set = rhs.move_set;
+      cube_set = rhs.cube_set;
+      done = rhs.done;
+      plan_action_set = rhs.plan_action_set;
+      stage_set = rhs.stage_set;
+      solution_cache = rhs.solution_cache;
+      owns_solution_cache = false;
+      state_table = rhs.state_table;
+      trace = rhs.trace;
+      random = rhs.random;
+      solution_valid = rhs.solution_valid;
+      solution = rhs.solution;
+      search_statistics = rhs.search_statistics;
+      search_statistics_command = rhs.search_statistics_command;
+    }
+
+    /* The sets are only shared by copies, and were made non-const by
+     * make_shared, so a set this AppData alone holds may be changed.
+     */
+    MoveSet& AppData::editMoveSet( ) {
+      if( move_set.use_count( ) > 1 ) {
+        move_set = std::make_shared< MoveSet >( *move_set );
+      }
+      return const_cast< MoveSet& >( *move_set );
+    }
+
+    CubeSet& AppData::editCubeSet( ) {
+      if( cube_set.use_count( ) > 1 ) {
+        cube_set = std::make_shared< CubeSet >( *cube_set );
+      }
+      return const_cast< CubeSet& >( *cube_set );
+    }
+
+    PlanActionSet& AppData::editPlanActionSet( ) {
+      if( plan_action_set.use_count( ) > 1 ) {
+        plan_action_set = std::make_shared< PlanActionSet >( *plan_action_set );
+      }
+      return const_cast< PlanActionSet& >( *plan_action_set );
+    }
+
+    void AppData::seedRandom( ) {
+      random.seed( config.seed( ) != 0 ? config.seed( ) : Random::clockSeed( ) );
+    }
+
+    int init_cube( AppData& data, Cube& cube, unsigned int first_word, unsigned int last_word ) {
+      std::stringstream ss;
+      unsigned int i;
+      for( i = first_word; i < last_word; i++ ) {
+        ss << data.words[ i ];
+      }
+      if( ss.str( ) == "solved" ) {
+        cube.assignSolved( );
+      } else if( data.cube_set->cubeIsDefined( ss.str( ) ) ) {
+        cube = data.cube_set->getDefinedCube( ss.str( ) );
+      } else {
+        if( ss.str( ).size( ) != cube.getFacelets( ).size( ) ) {
+          data.os << "Initialization string of incorrect size: \"" << ss.str( ) << "\"" << std::endl;
+          return EXIT_USAGE_HELP;
+        }
+        cube.assignFromString( ss.str( ) );
+      }
+      return EXIT_OK;
     }
 
     int AppData::setLegalMoves( ) {
+      MoveSet& move_set = editMoveSet( );
       move_set.clearMoves( );
       move_set.addBasicMoves( );
       if( config.halfTurns( ) ) {
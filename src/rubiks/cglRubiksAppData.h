@@ -5,12 +5,19 @@
 #include "cglRubiksMoveSet.h"
 #include "cglRubiksCubeSet.h"
 #include "cglRubiksPlanAction.h"
+#include "cglRubiksStageSet.h"
+#include "cglRubiksSolutionCache.h"
+#include "cglRubiksStateSetFile.h"
+#include "cglRubiksRandom.h"
 #include "cglRubiksCube.h"
 #include "cglRubiksCommand.h"
+#include "ai_search.h"
 #include <iostream>
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
+#include <unordered_map>
 
 namespace cgl {
   namespace rubiks {
@@ -18,20 +25,37 @@ namespace cgl {
     struct AppData {
       AppData( std::istream &is_in, std::ostream &os_in );
       int setLegalMoves( );
+      // copy everything except the streams and the words being processed
+      void copyState( const AppData& rhs );
+      // the sets below, copied first if another AppData shares them
+      MoveSet& editMoveSet( );
+      CubeSet& editCubeSet( );
+      PlanActionSet& editPlanActionSet( );
+      // reseeds random from config.seed( )
+      void seedRandom( );
       AppConfig config;
       Cube cube;
       std::vector< Cube > goal_cubes;
       std::istream &is;
       std::ostream &os;
       std::vector< std::string > words;  // for line-by-line processing
-      std::map< std::string, ActionRecord > actions;
-      MoveSet move_set;
-      CubeSet cube_set;
+      std::unordered_map< std::string, ActionRecord > actions;
+      // shared by copies until changed through an edit function
+      std::shared_ptr< const MoveSet > move_set;
+      std::shared_ptr< const CubeSet > cube_set;
       bool    done;
-      PlanActionSet plan_action_set;
+      std::shared_ptr< const PlanActionSet > plan_action_set;
+      StageSet      stage_set;
+      std::shared_ptr< SolutionCache > solution_cache; // shared by copies
+      bool owns_solution_cache; // false in copies, whose config does not resize the shared cache
+      std::shared_ptr< const StateTable > state_table; // shared by copies, replaced by load
+      std::shared_ptr< ai::Search::TraceFileWriter > trace; // shared by copies, null when not tracing
+      Random random; // copies that run concurrently get their own stream( )
       //
       bool        solution_valid;
       std::string solution;
+      ai::Search::Statistics search_statistics; // of the last search, plan or hla_solve
+      std::string            search_statistics_command;
     };
 
   }
@@ -1,7 +1,10 @@
 #ifndef _CGLRUBIKSCOMMAND_H_
 #define _CGLRUBIKSCOMMAND_H_
 
+#include <climits>
+#include <istream>
 #include <string>
+#include <vector>
 
 namespace cgl {
   namespace rubiks {
@@ -15,13 +18,35 @@ namespace cgl {
       std::string        name;    // the keyword
       std::string        usage;   // usage message
       std::string        help;    // help message
+      unsigned int       max_words = UINT_MAX; // longer lines are refused, see serve
     };
 
     enum ExitStatus { EXIT_OK, EXIT_USAGE, EXIT_HELP, EXIT_USAGE_HELP, EXIT_EXIT, EXIT_THROW };
 
+    /* cglRubiksAppData.cpp */
+    class Cube;
+    int init_cube( AppData& data, Cube& cube, unsigned int first_word, unsigned int last_word );
+
+    /* cglRubiksMain.cpp */
+    void process_input_stream_aux( AppData& data );
+    void process_input_stream_aux( AppData& data, std::istream& is );
+
+    /* cglRubiksProfile.cpp */
+    int profile_heuristic( AppData& data );
+
     /* cglRubiksSearch.cpp */
     int search( AppData& data );
     int plan( AppData& data );
+    int hla_solve( AppData& data );
+    int batch( AppData& data );
+    /* Reads one cube per line.  A line starting with a move name is a
+     * scramble, applied to the current cube.  Any other line is a cube
+     * configuration, as for init cube.  Lines starting with # are skipped.
+     */
+    int read_cube_file( AppData& data, std::istream& is, std::vector< Cube >& cubes );
+
+    /* cglRubiksServe.cpp */
+    int serve( AppData& data );
 
   }
 }
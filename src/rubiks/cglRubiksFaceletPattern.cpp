@@ -0,0 +1,139 @@
+#include "cglRubiksFaceletPattern.h"
+#include <cstring>
+
+namespace cgl {
+  namespace rubiks {
+
+    /**************************************************************
+     *
+     * PackedCube class
+     *
+     */
+
+    PackedCube::PackedCube( )
+      : mHasWildcard( false ) {
+      std::memset( mBytes, 0, sizeof( mBytes ) );
+    }
+
+    PackedCube::PackedCube( const Cube& cube ) {
+      assign( cube );
+    }
+
+    void PackedCube::assign( const Cube& cube ) {
+      const std::vector< Facelet >& facelets = cube.getFacelets( );
+      std::memset( mBytes, 0, sizeof( mBytes ) );
+      std::memcpy( mBytes, facelets.data( ), NUM_POSITIONS_TOTAL );
+      mHasWildcard = std::memchr( mBytes, '*', NUM_POSITIONS_TOTAL ) != 0;
+    }
+
+    std::uint64_t PackedCube::getWord( const int word ) const {
+      std::uint64_t w;
+      std::memcpy( &w, mBytes + 8 * word, sizeof( w ) );
+      return w;
+    }
+
+    Facelet PackedCube::getFacelet( const int position ) const {
+      return static_cast< Facelet >( mBytes[ position ] );
+    }
+
+    bool PackedCube::hasWildcard( ) const {
+      return mHasWildcard;
+    }
+
+    /*
+     *
+     * PackedCube class
+     *
+     **************************************************************/
+
+    /**************************************************************
+     *
+     * FaceletPattern class
+     *
+     */
+
+    FaceletPattern::FaceletPattern( ) {
+      std::memset( mMask, 0, sizeof( mMask ) );
+      std::memset( mValue, 0, sizeof( mValue ) );
+    }
+
+    FaceletPattern::FaceletPattern( const Cube& pattern ) {
+      assign( pattern );
+    }
+
+    void FaceletPattern::assign( const Cube& pattern ) {
+      std::memset( mMask, 0, sizeof( mMask ) );
+      std::memset( mValue, 0, sizeof( mValue ) );
+      const std::vector< Facelet >& facelets = pattern.getFacelets( );
+      int i;
+      for( i = 0; i < NUM_POSITIONS_TOTAL; i++ ) {
+        if( facelets[ i ] != '*' ) {
+          mMask[ i ] = 0xff;
+          mValue[ i ] = static_cast< unsigned char >( facelets[ i ] );
+        }
+      }
+    }
+
+    bool FaceletPattern::matches( const PackedCube& cube ) const {
+      if( cube.hasWildcard( ) ) {
+        /* a '*' in the cube also matches anything, rare enough to do byte by byte */
+        int i;
+        for( i = 0; i < NUM_POSITIONS_TOTAL; i++ ) {
+          Facelet f = cube.getFacelet( i );
+          if( mMask[ i ] && f != '*' && static_cast< unsigned char >( f ) != mValue[ i ] ) {
+            return false;
+          }
+        }
+        return true;
+      }
+      /* branch free, so the compiler can turn this into vector operations */
+      std::uint64_t diff = 0;
+      int w;
+      for( w = 0; w < NUM_PACKED_WORDS; w++ ) {
+        diff |= ( cube.getWord( w ) & getMaskWord( w ) ) ^ getValueWord( w );
+      }
+      return diff == 0;
+    }
+
+    bool FaceletPattern::constrains( const int position ) const {
+      return mMask[ position ] != 0;
+    }
+
+    Facelet FaceletPattern::getFacelet( const int position ) const {
+      if( mMask[ position ] ) {
+        return static_cast< Facelet >( mValue[ position ] );
+      }
+      return '*';
+    }
+
+    int FaceletPattern::countConstrained( ) const {
+      int count = 0;
+      int i;
+      for( i = 0; i < NUM_POSITIONS_TOTAL; i++ ) {
+        if( mMask[ i ] ) {
+          count++;
+        }
+      }
+      return count;
+    }
+
+    std::uint64_t FaceletPattern::getMaskWord( const int word ) const {
+      std::uint64_t w;
+      std::memcpy( &w, mMask + 8 * word, sizeof( w ) );
+      return w;
+    }
+
+    std::uint64_t FaceletPattern::getValueWord( const int word ) const {
+      std::uint64_t w;
+      std::memcpy( &w, mValue + 8 * word, sizeof( w ) );
+      return w;
+    }
+
+    /*
+     *
+     * FaceletPattern class
+     *
+     **************************************************************/
+
+  }
+}
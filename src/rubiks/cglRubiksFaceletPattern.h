@@ -0,0 +1,75 @@
+#ifndef _CGLRUBIKSFACELETPATTERN_H_
+#define _CGLRUBIKSFACELETPATTERN_H_
+
+#include "cglRubiksCube.h"
+#include <cstdint>
+
+namespace cgl {
+  namespace rubiks {
+
+    /* Facelets are padded out to 64 bytes, so a compare is 8 word
+     * operations (or one 64 byte vector operation) instead of 54
+     * character compares with wildcard branches.
+     */
+    const int NUM_PACKED_BYTES = 64;
+    const int NUM_PACKED_WORDS = NUM_PACKED_BYTES / 8;
+
+    /*
+     * The facelets of a cube, copied into 64 aligned bytes.
+     * Padding bytes are 0.
+     */
+    class PackedCube {
+    public:
+      PackedCube( );
+      PackedCube( const Cube& cube );
+      void assign( const Cube& cube );
+
+      std::uint64_t getWord( const int word ) const;
+      Facelet getFacelet( const int position ) const;
+      // true if any facelet is '*', which matches anything
+      bool hasWildcard( ) const;
+
+    protected:
+      alignas( NUM_PACKED_BYTES ) unsigned char mBytes[ NUM_PACKED_BYTES ];
+      bool mHasWildcard;
+
+    private:
+    };
+
+    /*
+     * A wildcard cube compiled into a mask/value pair.
+     * mask bytes are 0xff where the pattern has a facelet, 0 where it has '*'.
+     * value bytes are the pattern facelet where mask is set, 0 elsewhere.
+     * A cube matches when ( cube & mask ) == value.
+     */
+    class FaceletPattern {
+    public:
+      FaceletPattern( );
+      FaceletPattern( const Cube& pattern );
+      void assign( const Cube& pattern );
+
+      /* Same result as cube == pattern for the Cube class. */
+      bool matches( const PackedCube& cube ) const;
+
+      bool constrains( const int position ) const;
+      // the required facelet, or '*' if unconstrained
+      Facelet getFacelet( const int position ) const;
+      int countConstrained( ) const;
+
+      std::uint64_t getMaskWord( const int word ) const;
+      std::uint64_t getValueWord( const int word ) const;
+
+    protected:
+      alignas( NUM_PACKED_BYTES ) unsigned char mMask[ NUM_PACKED_BYTES ];
+      alignas( NUM_PACKED_BYTES ) unsigned char mValue[ NUM_PACKED_BYTES ];
+
+    private:
+    };
+
+  }
+}
+
+#endif /* _CGLRUBIKSFACELETPATTERN_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
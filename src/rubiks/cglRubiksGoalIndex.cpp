@@ -0,0 +1,107 @@
+#include "cglRubiksGoalIndex.h"
+#include <map>
+
+namespace cgl {
+  namespace rubiks {
+
+    GoalIndex::GoalIndex( const std::vector< Cube >& goals )
+      : mGoals( goals ) {
+      std::map< std::vector< int >, unsigned int > group_by_positions;
+      for( auto it = mGoals.begin( ); it != mGoals.end( ); it++ ) {
+        const std::vector< Facelet >& facelets = it->getFacelets( );
+        std::vector< int > positions;
+        std::string key;
+        int i;
+        for( i = 0; i < NUM_POSITIONS_TOTAL; i++ ) {
+          if( facelets[ i ] != '*' ) {
+            positions.push_back( i );
+            key += facelets[ i ];
+          }
+        }
+
+        auto found = group_by_positions.find( positions );
+        if( found == group_by_positions.end( ) ) {
+          found = group_by_positions.insert( std::make_pair( positions, mGroups.size( ) ) ).first;
+          Group group;
+          group.positions = positions;
+          group.allowed.resize( positions.size( ) );
+          mGroups.push_back( group );
+        }
+        Group& group = mGroups[ found->second ];
+        group.keys.insert( key );
+        unsigned int j;
+        for( j = 0; j < positions.size( ); j++ ) {
+          group.allowed[ j ].set( static_cast< unsigned char >( key[ j ] ) );
+        }
+      }
+    }
+
+    bool GoalIndex::matches( const Cube& cube ) const {
+      const std::vector< Facelet >& facelets = cube.getFacelets( );
+      std::string key;
+      for( auto group = mGroups.begin( ); group != mGroups.end( ); group++ ) {
+        key.clear( );
+        bool wildcard = false;
+        for( auto p = group->positions.begin( ); p != group->positions.end( ); p++ ) {
+          if( facelets[ *p ] == '*' ) {
+            wildcard = true;
+            break;
+          }
+          key += facelets[ *p ];
+        }
+        if( wildcard ) {
+          /* a wildcard in the cube matches anything, rare enough to scan */
+          for( auto it = mGoals.begin( ); it != mGoals.end( ); it++ ) {
+            if( cube == *it ) {
+              return true;
+            }
+          }
+          return false;
+        }
+        if( group->keys.count( key ) > 0 ) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    int GoalIndex::mismatchLowerBound( const Cube& cube, const PositionSet& positions ) const {
+      const std::vector< Facelet >& facelets = cube.getFacelets( );
+      int best_count = 2 * NUM_POSITIONS_TOTAL;
+      for( auto group = mGroups.begin( ); group != mGroups.end( ); group++ ) {
+        unsigned int i;
+        if( group->keys.size( ) <= MAX_EXACT_GOALS ) {
+          for( auto key = group->keys.begin( ); key != group->keys.end( ); key++ ) {
+            int count = 0;
+            for( i = 0; i < group->positions.size( ) && count < best_count; i++ ) {
+              int p = group->positions[ i ];
+              if( positions[ p ] && facelets[ p ] != ( *key )[ i ] ) {
+                count++;
+              }
+            }
+            if( count < best_count ) {
+              best_count = count;
+            }
+          }
+        } else {
+          int count = 0;
+          for( i = 0; i < group->positions.size( ) && count < best_count; i++ ) {
+            int p = group->positions[ i ];
+            if( positions[ p ] && !group->allowed[ i ][ static_cast< unsigned char >( facelets[ p ] ) ] ) {
+              count++;
+            }
+          }
+          if( count < best_count ) {
+            best_count = count;
+          }
+        }
+      }
+      return best_count;
+    }
+
+    unsigned int GoalIndex::getNumGroups( ) const {
+      return mGroups.size( );
+    }
+
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef _CGLRUBIKSGOALINDEX_H_
+#define _CGLRUBIKSGOALINDEX_H_
+
+#include "cglRubiksCube.h"
+#include <bitset>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    typedef std::bitset< NUM_POSITIONS_TOTAL > PositionSet;
+
+    /*
+     * Goal cubes grouped by their wildcard mask.  Within a group, the
+     * facelets at the constrained positions are hashed, so testing a
+     * cube against all goals costs one probe per group, however many
+     * goals there are.
+     *
+     * Each group also records the colors allowed at each position by
+     * any of its goals.  Small groups count mismatched facelets goal by
+     * goal; large groups use the allowed colors, a weaker lower bound
+     * whose cost does not grow with the number of goals.
+     */
+    class GoalIndex {
+    public:
+      GoalIndex( const std::vector< Cube >& goals );
+
+      /* Same result as comparing cube == goal for every goal. */
+      bool matches( const Cube& cube ) const;
+
+      /* At most the fewest facelets, among positions, that differ from
+       * any one goal, and exactly that when every group is small.
+       * Wildcards in the cube count as mismatches.
+       * Returns 2 * NUM_POSITIONS_TOTAL if there are no goals.
+       */
+      int mismatchLowerBound( const Cube& cube, const PositionSet& positions ) const;
+
+      unsigned int getNumGroups( ) const;
+
+    protected:
+      struct Group {
+        std::vector< int > positions; // constrained positions
+        std::unordered_set< std::string > keys; // facelets at positions, one per goal
+        std::vector< std::bitset< 256 > > allowed; // colors allowed at positions[ i ]
+      };
+
+      /* groups with more goals than this use the allowed colors bound */
+      static const unsigned int MAX_EXACT_GOALS = 16;
+
+      std::vector< Cube >  mGoals;
+      std::vector< Group > mGroups;
+
+    private:
+    };
+
+  }
+}
+
+
+#endif /* _CGLRUBIKSGOALINDEX_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
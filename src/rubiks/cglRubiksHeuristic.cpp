@@ -0,0 +1,91 @@
+#include "cglRubiksHeuristic.h"
+#include <algorithm>
+#include <limits>
+
+namespace cgl {
+  namespace rubiks {
+
+    HeuristicPipeline::HeuristicPipeline( )
+      : mCombine( COMBINE_MAX ), mCalls( 0 ), mCutoffs( 0 ) {
+      // empty
+    }
+
+    void HeuristicPipeline::clear( ) {
+      mComponents.clear( );
+      clearStats( );
+    }
+
+    void HeuristicPipeline::setCombine( const CombineEnum& combine ) {
+      mCombine = combine;
+    }
+
+    HeuristicPipeline::CombineEnum HeuristicPipeline::getCombine( ) const {
+      return mCombine;
+    }
+
+    void HeuristicPipeline::addComponent( const std::string& name, const Function& function, const double relative_cost ) {
+      Component component = { name, function, relative_cost, 0 };
+      /* keep the components sorted cheapest first, stable for equal costs */
+      auto it = std::upper_bound( mComponents.begin( ), mComponents.end( ), component,
+                                  []( const Component& lhs, const Component& rhs ) {
+                                    return lhs.relative_cost < rhs.relative_cost;
+                                  } );
+      mComponents.insert( it, component );
+    }
+
+    bool HeuristicPipeline::empty( ) const {
+      return mComponents.size( ) == 0;
+    }
+
+    double HeuristicPipeline::evaluate( const ai::Search::State * const state_in ) const {
+      return evaluate( state_in, std::numeric_limits< double >::infinity( ) );
+    }
+
+    double HeuristicPipeline::evaluate( const ai::Search::State * const state_in, const double bound ) const {
+      mCalls++;
+      double h = 0.0;
+      unsigned int i;
+      for( i = 0; i < mComponents.size( ); i++ ) {
+        if( i > 0 && h > bound ) {
+          mCutoffs++;
+          break;
+        }
+        const Component& component = mComponents[ i ];
+        component.evaluations++;
+        double value = component.function( state_in );
+        if( mCombine == COMBINE_SUM ) {
+          h += value;
+        } else if( value > h ) {
+          h = value;
+        }
+      }
+      return h;
+    }
+
+    void HeuristicPipeline::clearStats( ) {
+      mCalls = 0;
+      mCutoffs = 0;
+      for( auto it = mComponents.begin( ); it != mComponents.end( ); it++ ) {
+        it->evaluations = 0;
+      }
+    }
+
+    size_t HeuristicPipeline::getCalls( ) const {
+      return mCalls;
+    }
+
+    size_t HeuristicPipeline::getCutoffs( ) const {
+      return mCutoffs;
+    }
+
+    void HeuristicPipeline::displayStats( std::ostream& os ) const {
+      for( auto it = mComponents.begin( ); it != mComponents.end( ); it++ ) {
+        os << "Heuristic " << it->name << " evaluated " << it->evaluations << " times." << std::endl;
+      }
+      if( mComponents.size( ) > 1 ) {
+        os << "Heuristic early cutoffs " << mCutoffs << " of " << mCalls << " calls." << std::endl;
+      }
+    }
+
+  }
+}
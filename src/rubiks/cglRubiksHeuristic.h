@@ -0,0 +1,69 @@
+#ifndef _CGLRUBIKSHEURISTIC_H_
+#define _CGLRUBIKSHEURISTIC_H_
+
+#include "ai_search.h"
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*
+     * HeuristicPipeline combines several heuristic components into
+     * one estimate, either as the maximum of the components, or as
+     * the sum of additive (disjoint) components.
+     *
+     * Components are evaluated from cheapest to most expensive.
+     * Since both combinations only grow as components are added,
+     * evaluation stops as soon as the running value exceeds the
+     * bound supplied by a bounded search.  The partial value is
+     * returned, which is enough for the search to prune the node.
+     */
+    class HeuristicPipeline {
+    public:
+      enum CombineEnum { COMBINE_MAX, COMBINE_SUM };
+      typedef std::function< double( const ai::Search::State * const ) > Function;
+
+      HeuristicPipeline( );
+      void clear( );
+      void setCombine( const CombineEnum& combine );
+      CombineEnum getCombine( ) const;
+
+      /* relative_cost only orders the components, lower is evaluated first */
+      void addComponent( const std::string& name, const Function& function, const double relative_cost );
+      bool empty( ) const;
+
+      double evaluate( const ai::Search::State * const state_in ) const;
+      double evaluate( const ai::Search::State * const state_in, const double bound ) const;
+
+      // evaluation statistics
+      void clearStats( );
+      size_t getCalls( ) const;
+      size_t getCutoffs( ) const;
+      void displayStats( std::ostream& os ) const;
+
+    protected:
+      struct Component {
+        std::string    name;
+        Function       function;
+        double         relative_cost;
+        mutable size_t evaluations;
+      };
+
+      std::vector< Component > mComponents;
+      CombineEnum              mCombine;
+      mutable size_t           mCalls;
+      mutable size_t           mCutoffs;
+
+    private:
+    };
+
+  }
+}
+
+#endif /* _CGLRUBIKSHEURISTIC_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
@@ -8,87 +8,206 @@
 #include "cglRubiksMoveSet.h"
 #include "cglRubiksCubeSet.h"
 #include "cglRubiksAppData.h"
+#include "cglRubiksStateSetFile.h"
+#include "cglRubiksRandomCube.h"
+#include "cglRubiksTokenizer.h"
 #include "ai_search.h"
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <iomanip>
 #include <ctime>
 #include <cstdlib>
-#include <sys/time.h>
+#include <cctype>
 #include <chrono>
 #include <map>
 #include <algorithm>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <unistd.h> // For isatty
 #include <cstdio>   // For fileno
 
 namespace cgl {
   namespace rubiks {
 
-    void process_input_stream_aux( AppData& data );
 
     /*********************************************
      * Problem Generation
      */
-    /* generate all cubes within `depth` moves of cube */
-    void generate_cubes_aux( cgl::rubiks::Cube& cube, std::map< cgl::rubiks::Cube, std::pair< int, int > >& cubes, const int& depth, const int& max_depth, AppData& data ) {
-      if( depth >= max_depth ) {
-      } else {
-        for( auto it = data.move_set.getMoves( ).begin( );
-             it != data.move_set.getMoves( ).end( );
-             it++ ) {
+    /* a cube's facelets, and the number of shortest paths that reach it */
+    typedef std::vector< std::pair< std::string, std::uint64_t > > GenerateLayer;
 
-          const Move& move = it->second;
-          cube = move * cube;
-          
-          if( cubes.find( cube ) == cubes.end( ) ) {
-            cubes[ cube ].first = 1;
-            cubes[ cube ].second = depth+1;
-          } else {
-            cubes[ cube ].first += 1;
-            if( cubes[ cube ].second > depth + 1 ) {
-              cubes[ cube ].second = depth+1;
+    /* successors of layer[ begin, end ) that are not in seen, each once,
+     * with the paths through layer[ begin, end ) that reach them
+     */
+    static void generate_layer_aux( const GenerateLayer& layer, const size_t begin, const size_t end,
+                                    const std::vector< std::vector< int > >& transforms,
+                                    const std::unordered_set< std::string >& seen,
+                                    GenerateLayer& successors ) {
+      std::unordered_map< std::string, size_t > found;
+      std::string next( NUM_POSITIONS_TOTAL, ' ' );
+      size_t i;
+      for( i = begin; i < end; i++ ) {
+        const std::string& current = layer[ i ].first;
+        for( auto t = transforms.begin( ); t != transforms.end( ); t++ ) {
+          unsigned int p;
+          for( p = 0; p < current.size( ); p++ ) {
+            next[ ( *t )[ p ] ] = current[ p ];
+          }
+          if( seen.count( next ) == 0 ) {
+            auto it = found.insert( std::make_pair( next, successors.size( ) ) );
+            if( it.second ) {
+              successors.push_back( std::make_pair( next, 0 ) );
             }
+            successors[ it.first->second ].second += layer[ i ].second;
           }
-
-          generate_cubes_aux( cube, cubes, depth+1, max_depth, data );
-          cube = cube * move;
         }
       }
     }
 
+    /* generate all cubes within `depth` moves of cube, one layer at a time.
+     * Each layer is expanded by several threads, then merged, sorted and
+     * written before the next one is started.
+     */
     int generate_cubes( AppData& data ) {
-      if ( data.words.size( ) < 3 ) {
+      if ( data.words.size( ) < 3 || data.words.size( ) > 4 ) {
         return EXIT_USAGE;
       }
-      std::stringstream ss( data.words[ 1 ] );
       int max_depth = 0;
-      ss >> max_depth;
+      parse_number( data.words[ 1 ], max_depth );
 
-      std::string filename;
-      ss.clear( );
-      ss.str( data.words[ 2 ] );
-      ss >> filename;
+      const std::string& filename = data.words[ 2 ];
 
-      std::map< cgl::rubiks::Cube, std::pair< int, int > > cubes;
-
-      cubes[ data.cube ].first = 1;
-      cubes[ data.cube ].second = 0;
-      generate_cubes_aux( data.cube, cubes, 0, max_depth, data );
+      bool binary = false;
+      if( data.words.size( ) == 4 ) {
+        if( data.words[ 3 ] == "binary" ) {
+          binary = true;
+        } else if( data.words[ 3 ] != "text" ) {
+          return EXIT_USAGE;
+        }
+      }
 
-      std::ofstream fout( filename );
-      if( !fout  ) {
+      std::ofstream fout;
+      StateSetWriter writer;
+      bool opened;
+      if( binary ) {
+        opened = writer.open( filename, data.cube, data.move_set->getMoves( ) );
+      } else {
+        fout.open( filename );
+        opened = static_cast< bool >( fout );
+      }
+      if( !opened ) {
         data.os << "Unable to open " << filename << "." << std::endl;
         return EXIT_USAGE_HELP;
       }
-      std::map< cgl::rubiks::Cube, std::pair< int, int > >::iterator it;
-      for( it = cubes.begin( ); it != cubes.end( ); it++ ) {
-        it->first.oneWordDisplay( fout );
-        fout << " " << it->second.second << std::endl;
+
+      std::vector< std::vector< int > > transforms;
+      for( auto it = data.move_set->getMoves( ).begin( ); it != data.move_set->getMoves( ).end( ); it++ ) {
+        transforms.push_back( it->second.getTransform( ) );
       }
-      fout.close( );
-      data.os << "Saved " << cubes.size( ) << " entries to " << filename << "." << std::endl;
+      unsigned int num_threads = data.config.workerThreads( );
+
+      const std::vector< Facelet >& facelets = data.cube.getFacelets( );
+      GenerateLayer layer( 1, std::make_pair( std::string( facelets.begin( ), facelets.end( ) ), 1 ) );
+      std::unordered_set< std::string > seen = { layer[ 0 ].first };
+      size_t count = 0;
+      int depth;
+      for( depth = 0; ; depth++ ) {
+        if( binary ) {
+          writer.beginLayer( depth, layer.size( ) );
+        }
+        for( auto it = layer.begin( ); it != layer.end( ); it++ ) {
+          if( binary ) {
+            writer.writeState( it->first, it->second );
+          } else {
+            fout << it->first << " " << depth << '\n';
+          }
+        }
+        count += layer.size( );
+        if( depth >= max_depth || layer.empty( ) ) {
+          break;
+        }
+
+        /* seen is only read while the threads run */
+        const size_t num_chunks = std::min( static_cast< size_t >( num_threads ), layer.size( ) );
+        std::vector< GenerateLayer > successors( num_chunks );
+        std::vector< std::thread > workers;
+        size_t i;
+        for( i = 0; i < num_chunks; i++ ) {
+          const size_t begin = layer.size( ) * i / num_chunks;
+          const size_t end = layer.size( ) * ( i + 1 ) / num_chunks;
+          workers.push_back( std::thread( generate_layer_aux, std::cref( layer ), begin, end, std::cref( transforms ),
+                                          std::cref( seen ), std::ref( successors[ i ] ) ) );
+        }
+        for( auto it = workers.begin( ); it != workers.end( ); it++ ) {
+          it->join( );
+        }
+
+        std::unordered_map< std::string, std::uint64_t > paths;
+        for( auto chunk = successors.begin( ); chunk != successors.end( ); chunk++ ) {
+          for( auto it = chunk->begin( ); it != chunk->end( ); it++ ) {
+            paths[ it->first ] += it->second;
+          }
+        }
+        GenerateLayer next_layer( paths.begin( ), paths.end( ) );
+        std::sort( next_layer.begin( ), next_layer.end( ) );
+        for( auto it = next_layer.begin( ); it != next_layer.end( ); it++ ) {
+          seen.insert( it->first );
+        }
+        layer.swap( next_layer );
+      }
+      bool ok = binary ? writer.close( ) : static_cast< bool >( fout.flush( ) );
+      if( !ok ) {
+        data.os << "Unable to write " << filename << "." << std::endl;
+        return EXIT_USAGE_HELP;
+      }
+      data.os << "Saved " << count << " entries to " << filename << "." << std::endl;
       return EXIT_OK;
     }
+
+    /* read a binary state set file into named cubes or the state table */
+    int load( AppData& data ) {
+      if( data.words.size( ) < 3 ) {
+        return EXIT_USAGE;
+      }
+      const std::string& filename = data.words[ 1 ];
+      if( data.words[ 2 ] == "cubes" && data.words.size( ) == 4 ) {
+        StateSetReader reader;
+        if( !reader.open( filename ) ) {
+          data.os << reader.getError( ) << std::endl;
+          return EXIT_USAGE_HELP;
+        }
+        StateSetReader::Record record;
+        size_t count = 0;
+        Cube cube;
+        CubeSet& cube_set = data.editCubeSet( );
+        while( reader.next( record ) ) {
+          cube.assignFromString( record.facelets );
+          std::stringstream name;
+          name << data.words[ 3 ] << count;
+          cube_set.defineCube( name.str( ), cube );
+          count++;
+        }
+        if( !reader.isComplete( ) ) {
+          data.os << reader.getError( ) << std::endl;
+        }
+        data.os << "Loaded " << count << " entries from " << filename << "." << std::endl;
+        return reader.isComplete( ) ? EXIT_OK : EXIT_USAGE_HELP;
+      } else if( data.words[ 2 ] == "table" && data.words.size( ) == 3 ) {
+        /* copies of data may still be reading the old table */
+        std::shared_ptr< StateTable > table = std::make_shared< StateTable >( );
+        std::string error;
+        if( !table->load( filename, error ) ) {
+          data.os << error << std::endl;
+          return EXIT_USAGE_HELP;
+        }
+        data.state_table = table;
+        data.os << "Loaded " << table->size( ) << " entries from " << filename << "." << std::endl;
+        return EXIT_OK;
+      }
+      return EXIT_USAGE;
+    }
     /*
      * Problem Generation
      *********************************************/  
@@ -122,6 +241,8 @@ namespace cgl {
         if( ( data.words[ 1 ] == "enable_half" ) ||
             ( data.words[ 1 ] == "enable_slice" ) ) {
           data.setLegalMoves( );
+        } else if( data.words[ 1 ] == "seed" ) {
+          data.seedRandom( );
         }
       }
       return EXIT_OK;
@@ -230,38 +351,58 @@ namespace cgl {
         return exit_code;
       } else if( data.words[ 1 ] == "moves" ) {
         data.os << "Moves:";
-        return show_moves( data, data.move_set.getMoves( ) );
+        return show_moves( data, data.move_set->getMoves( ) );
       } else if( data.words[ 1 ] == "defined_moves" ) {
         data.os << "Defined Moves:";
-        return show_moves( data, data.move_set.getDefinedMoves( ) );
+        return show_moves( data, data.move_set->getDefinedMoves( ) );
       } else if( data.words[ 1 ] == "defined_cubes" ) {
         data.os << "Defined Cubes:" << std::endl;
-        return show_cubes( data, data.cube_set.getDefinedCubes( ) );
+        return show_cubes( data, data.cube_set->getDefinedCubes( ) );
       } else if( data.words[ 1 ] == "defined_plan_actions" ) {
         data.os << "Defined Plan Actions:" << std::endl;
-        return show_plan_actions( data, data.plan_action_set.getDefinedActions( ) );
-      }
-      return EXIT_USAGE_HELP;
-    }
-
-    int init_cube( AppData& data, Cube& cube, unsigned int first_word, unsigned int last_word ) {
-      std::stringstream ss;
-      unsigned int i;
-      for( i = first_word; i < last_word; i++ ) {
-        ss << data.words[ i ];
-      }
-      if( ss.str( ) == "solved" ) {
-        cube.assignSolved( );
-      } else if( data.cube_set.cubeIsDefined( ss.str( ) ) ) {
-        cube = data.cube_set.getDefinedCube( ss.str( ) );
-      } else {
-        if( ss.str( ).size( ) != cube.getFacelets( ).size( ) ) {
-          data.os << "Initialization string of incorrect size: \"" << ss.str( ) << "\"" << std::endl;
-          return EXIT_USAGE_HELP;
+        return show_plan_actions( data, data.plan_action_set->getDefinedActions( ) );
+      } else if( data.words[ 1 ] == "cache" ) {
+        data.os << "Solution Cache:" << std::endl;
+        data.solution_cache->displayStats( data.os );
+        return EXIT_OK;
+      } else if( data.words[ 1 ] == "stats" ) {
+        data.os << "Search Statistics:" << std::endl;
+        if( data.search_statistics_command == "" ) {
+          data.os << "No search yet." << std::endl;
+          return EXIT_OK;
+        }
+        data.os << data.search_statistics_command << std::endl;
+        data.search_statistics.Display( data.os );
+        return EXIT_OK;
+      } else if( data.words[ 1 ] == "table" ) {
+        data.os << "State Table:" << std::endl;
+        if( data.state_table->size( ) == 0 ) {
+          data.os << "Empty." << std::endl;
+          return EXIT_OK;
+        }
+        data.os << "Entries " << data.state_table->size( ) << " to depth " << data.state_table->getMaxDepth( )
+                << " from " << data.state_table->getFilename( ) << "." << std::endl;
+        int depth;
+        std::uint64_t paths;
+        if( data.state_table->lookup( data.cube, depth, paths ) ) {
+          data.os << "Cube at depth " << depth << " with " << paths << " paths." << std::endl;
+        } else {
+          data.os << "Cube not found." << std::endl;
+        }
+        return EXIT_OK;
+      } else if( data.words[ 1 ] == "stages" ) {
+        data.os << "Stages:" << std::endl;
+        unsigned int i;
+        for( i = 0; i < data.stage_set.size( ); i++ ) {
+          data.os << i + 1 << " remembered " << data.stage_set.getMemoSize( i ) << " ";
+          int r = show_cube( data, data.stage_set.getStages( )[ i ] );
+          if( r != EXIT_OK ) {
+            return r;
+          }
         }
-        cube.assignFromString( ss.str( ) );
+        return EXIT_OK;
       }
-      return EXIT_OK;
+      return EXIT_USAGE_HELP;
     }
 
     int init_cube_vector( AppData& data, std::vector< Cube >& cubes, unsigned int first_word_in, unsigned int last_word_in ) {
@@ -275,7 +416,7 @@ namespace cgl {
       unsigned int count = 0;
       int exit_code = EXIT_OK;
       for( i = first_word_in; i < last_word_in; i++ ) {
-        if( count == 0 && ( data.cube_set.cubeIsDefined( data.words[ i ] ) || data.words[ i ] == "solved" ) ) {
+        if( count == 0 && ( data.cube_set->cubeIsDefined( data.words[ i ] ) || data.words[ i ] == "solved" ) ) {
           /* found a defined cube name */
           last_word = i + 1;
           cubes.resize( cubes.size( ) + 1 );
@@ -323,6 +464,14 @@ namespace cgl {
         return r;
       } else if( data.words[ 1 ] == "goal" ) {
         return init_cube_vector( data, data.goal_cubes, 2, data.words.size( ) );
+      } else if( data.words[ 1 ] == "stages" ) {
+        std::vector< Cube > stages;
+        int r = init_cube_vector( data, stages, 2, data.words.size( ) );
+        if( r != EXIT_OK ) {
+          return r;
+        }
+        data.stage_set.setStages( stages );
+        return r;
       }
       return EXIT_USAGE_HELP;
     }
@@ -330,27 +479,69 @@ namespace cgl {
     int shuffle_cube_aux( AppData& data, int count ) {
       int i;
       for( i = 0 ; i < count ; i++ ) {
-        data.cube = data.move_set.getRandomMove( ) * data.cube;
+        data.cube = data.move_set->getRandomMove( data.random ) * data.cube;
       }
       return EXIT_OK;
     }
 
+    /* uniformly random cubes, rather than random moves */
+    int shuffle_uniform( AppData& data ) {
+      RandomCubeSampler sampler( data.random.next( ) );
+      std::string facelets;
+      if( data.words.size( ) == 2 ) {
+        sampler.sample( data.cube, facelets );
+        data.cube.assignFromString( facelets );
+        return EXIT_OK;
+      } else if( data.words.size( ) != 4 ) {
+        return EXIT_USAGE;
+      }
+
+      long count = 0;
+      if( !parse_number( data.words[ 2 ], count ) || count < 0 ) {
+        return EXIT_USAGE_HELP;
+      }
+      const std::string& filename = data.words[ 3 ];
+      std::ofstream fout( filename );
+      if( !fout ) {
+        data.os << "Unable to open " << filename << "." << std::endl;
+        return EXIT_USAGE_HELP;
+      }
+      /* one cube_configuration per line, as read by batch */
+      std::string buffer;
+      long i;
+      for( i = 0; i < count; i++ ) {
+        sampler.sample( data.cube, facelets );
+        buffer += facelets;
+        buffer += '\n';
+        if( buffer.size( ) >= ( 1 << 20 ) ) {
+          fout.write( buffer.data( ), buffer.size( ) );
+          buffer.clear( );
+        }
+      }
+      fout.write( buffer.data( ), buffer.size( ) );
+      fout.close( );
+      if( !fout ) {
+        data.os << "Unable to write " << filename << "." << std::endl;
+        return EXIT_USAGE_HELP;
+      }
+      data.os << "Saved " << count << " entries to " << filename << "." << std::endl;
+      return EXIT_OK;
+    }
+
     int shuffle( AppData& data ) {
-      int num1, num2;
+      int num1 = 0, num2 = 0;
       if( data.words.size( ) < 2 ) {
         return EXIT_USAGE;
+      } else if( data.words[ 1 ] == "uniform" ) {
+        return shuffle_uniform( data );
       } else if( data.words.size( ) > 3 ) {
         return EXIT_USAGE;
       } else if( data.words.size( ) == 2 ) {
-        std::stringstream ss( data.words[ 1 ] );
-        ss >> num1;
+        parse_number( data.words[ 1 ], num1 );
         num2 = num1;
       } else if( data.words.size( ) == 3 ) {
-        std::stringstream ss( data.words[ 1 ] );
-        ss >> num1;
-        ss.clear( );
-        ss.str( data.words[ 2 ] );
-        ss >> num2;
+        parse_number( data.words[ 1 ], num1 );
+        parse_number( data.words[ 2 ], num2 );
       } else {
         return EXIT_USAGE_HELP;
       }
@@ -358,7 +549,7 @@ namespace cgl {
         return EXIT_USAGE_HELP;
       }
 
-      int count = num1 + ( std::rand( ) % ( num2 - num1 + 1 ) );
+      int count = num1 + data.random.below( num2 - num1 + 1 );
       return shuffle_cube_aux( data, count );
     }
 
@@ -387,8 +578,8 @@ namespace cgl {
           data.os << "FALSE" << std::endl;
         }
         return EXIT_OK;
-      } else if( data.cube_set.cubeIsDefined( data.words[ 1 ] ) ) {
-        rhs = data.cube_set.getDefinedCube( data.words[ 1 ] );
+      } else if( data.cube_set->cubeIsDefined( data.words[ 1 ] ) ) {
+        rhs = data.cube_set->getDefinedCube( data.words[ 1 ] );
       } else {
         if( init_cube( data, rhs, 1, data.words.size( ) ) != EXIT_OK ) {
           return EXIT_USAGE_HELP;
@@ -461,16 +652,24 @@ namespace cgl {
 
     int help( AppData& data ) {
       if( data.words.size( ) == 1 ) {
+        /* in alphabetical order, the map is hashed */
+        std::vector< std::string > names;
         for( auto it = data.actions.begin( ); it != data.actions.end( ); it++ ) {
-          data.os << it->second.usage << " :: ";
-          show_help( data.os, data, 0, it->second.help );
+          names.push_back( it->first );
+        }
+        std::sort( names.begin( ), names.end( ) );
+        for( auto it = names.begin( ); it != names.end( ); it++ ) {
+          const ActionRecord& record = data.actions.at( *it );
+          data.os << record.usage << " :: ";
+          show_help( data.os, data, 0, record.help );
           data.os << std::endl;
         }
       } else if( data.words.size( ) == 2 ) {
         const std::string& command = data.words[ 1 ];
-        if( data.actions.count( command ) > 0 ) {
-          data.os << data.actions.at( command ).usage << " :: ";
-          show_help( data.os, data, 0, data.actions.at( command ).help );
+        auto it = data.actions.find( command );
+        if( it != data.actions.end( ) ) {
+          data.os << it->second.usage << " :: ";
+          show_help( data.os, data, 0, it->second.help );
           data.os << std::endl;
         } else {
           data.os << "Unknown command: '" << command << "'. No help available." << std::endl;
@@ -491,39 +690,24 @@ namespace cgl {
       if( data.words.size( ) < 2 ) {
         return EXIT_USAGE;
       }
-      std::stringstream ss( data.words[ 1 ] );
-      std::string filename;
-      ss >> filename;
+      const std::string& filename = data.words[ 1 ];
 
       std::ifstream fin( filename );
       if( !fin ) {
         data.os << "Unable to open the file '" << filename << "'." << std::endl;
         exit_status = EXIT_USAGE;
       } else {
-        AppData tmp_data( fin, data.os );
-        tmp_data.config = data.config;
-        tmp_data.cube = data.cube;
-        tmp_data.goal_cubes = data.goal_cubes;
-        tmp_data.actions = data.actions;
-        tmp_data.move_set = data.move_set;
-        tmp_data.cube_set = data.cube_set;
-        tmp_data.done = data.done;
-        tmp_data.plan_action_set = data.plan_action_set;
-        tmp_data.solution_valid = data.solution_valid;
-        tmp_data.solution = data.solution;
-
-        process_input_stream_aux( tmp_data );
+        // the script shares data, only the words of this line are set aside
+        std::vector< std::string > words;
+        words.swap( data.words );
+        try {
+          process_input_stream_aux( data, fin );
+        } catch( ... ) {
+          data.words.swap( words );
+          throw;
+        }
+        data.words.swap( words );
         fin.close( );
-
-        data.config = tmp_data.config;
-        data.cube = tmp_data.cube;
-        data.goal_cubes = tmp_data.goal_cubes;
-        data.move_set = tmp_data.move_set;
-        data.cube_set = tmp_data.cube_set;
-        data.done = tmp_data.done;
-        data.plan_action_set = tmp_data.plan_action_set;
-        data.solution_valid = tmp_data.solution_valid;
-        data.solution = tmp_data.solution;
       }
 
       if( old_prompt ) {
@@ -540,11 +724,11 @@ namespace cgl {
       } else {
         unsigned int i;
         for( i = 1; i < data.words.size( ); i++ ) {
-          if( !data.move_set.moveExists( data.words[ i ] ) ) {
+          if( !data.move_set->moveExists( data.words[ i ] ) ) {
             data.os << "Unexpected move: ( " << data.words[ i ] << " )" << std::endl;
             return EXIT_USAGE_HELP;
           }
-          data.cube = data.move_set.getMove( data.words[ i ] ) * data.cube;
+          data.cube = data.move_set->getMove( data.words[ i ] ) * data.cube;
         }
       }
       
@@ -562,11 +746,12 @@ namespace cgl {
         for( i = 1; i < data.words.size( ); i++ ) {
           move_names.push_back( data.words[ i ] );
         }
-        data.move_set.clearMoves( );
-        int r = data.move_set.addMovesByName( move_names );
+        MoveSet& move_set = data.editMoveSet( );
+        move_set.clearMoves( );
+        int r = move_set.addMovesByName( move_names );
         if( r != EXIT_OK ) {
           for( i = 0; i < move_names.size( ); i++ ) {
-            if( !data.move_set.moveIsDefined( move_names[ i ] ) ) {
+            if( !data.move_set->moveIsDefined( move_names[ i ] ) ) {
               data.os << "Invalid move name used: " << move_names[ i ] << std::endl;
             }
           }
@@ -583,11 +768,11 @@ namespace cgl {
       std::vector< std::string > move_names;
       move = Move( Move::M_IDENTITY );
       for( i = first_word; i < last_word; i++ ) {
-        if( ! data.move_set.moveIsDefined( data.words[ i ] ) ) {
+        if( ! data.move_set->moveIsDefined( data.words[ i ] ) ) {
           data.os << data.words[ i ] << " is not a defined move." << std::endl;
           return EXIT_USAGE;
         }
-        move = data.move_set.getDefinedMove( data.words[ i ] ) * move;
+        move = data.move_set->getDefinedMove( data.words[ i ] ) * move;
       }
       return EXIT_OK;
     }
@@ -596,7 +781,7 @@ namespace cgl {
       const unsigned int move_name_index = 2;
       if( data.words.size( ) < move_name_index + 2 ) {
         return EXIT_USAGE;
-      } else if( data.move_set.moveIsDefined( data.words[ move_name_index ] ) ) {
+      } else if( data.move_set->moveIsDefined( data.words[ move_name_index ] ) ) {
         data.os << data.words[ move_name_index ] << " already defines a move." << std::endl;
         return EXIT_USAGE;
       } else if( data.words[ move_name_index + 1 ] == "solution" ) {
@@ -609,10 +794,10 @@ namespace cgl {
           Move move( Move::M_IDENTITY );
           ss >> m;
           while( ss ) {
-            move = data.move_set.getDefinedMove( m ) * move;
+            move = data.move_set->getDefinedMove( m ) * move;
             ss >> m;
           }
-          return data.move_set.defineMove( data.words[ move_name_index ], move );
+          return data.editMoveSet( ).defineMove( data.words[ move_name_index ], move );
         }
       } else {
         Move move( Move::M_IDENTITY );
@@ -620,7 +805,7 @@ namespace cgl {
         if( r != EXIT_OK ) {
           return r;
         }
-        return data.move_set.defineMove( data.words[ move_name_index ], move );
+        return data.editMoveSet( ).defineMove( data.words[ move_name_index ], move );
       }
     }
 
@@ -628,7 +813,7 @@ namespace cgl {
       const unsigned int cube_name_index = 2;
       if( data.words.size( ) < cube_name_index + 2 ) {
         return EXIT_USAGE;
-      } else if( data.cube_set.cubeIsDefined( data.words[ cube_name_index ] ) ) {
+      } else if( data.cube_set->cubeIsDefined( data.words[ cube_name_index ] ) ) {
         data.os << data.words[ cube_name_index ] << " already defines a cube." << std::endl;
         return EXIT_USAGE;
       } else {
@@ -643,7 +828,7 @@ namespace cgl {
           cube = cubes[ i ] + cube;
         }
 
-        return data.cube_set.defineCube( data.words[ cube_name_index ], cube );
+        return data.editCubeSet( ).defineCube( data.words[ cube_name_index ], cube );
       }
     }
 
@@ -651,7 +836,7 @@ namespace cgl {
       const unsigned int action_name_index = 2;
       if( data.words.size( ) < action_name_index + 5 ) {
         return EXIT_USAGE;
-      } else if( data.plan_action_set.actionIsDefined( data.words[ action_name_index ] ) ) {
+      } else if( data.plan_action_set->actionIsDefined( data.words[ action_name_index ] ) ) {
         data.os << data.words[ action_name_index ] << " already defines a plan action." << std::endl;
         return EXIT_USAGE;
       } else {
@@ -714,7 +899,7 @@ namespace cgl {
         }
         action.setEffect( effect );
 
-        return data.plan_action_set.defineAction( data.words[ action_name_index ], action );
+        return data.editPlanActionSet( ).defineAction( data.words[ action_name_index ], action );
       }
     }
 
@@ -733,27 +918,75 @@ namespace cgl {
       }
     }
 
+    int cache( AppData& data ) {
+      if( data.words.size( ) == 2 && data.words[ 1 ] == "clear" ) {
+        data.solution_cache->clear( );
+        return EXIT_OK;
+      } else if( data.words.size( ) == 3 && data.words[ 1 ] == "file" ) {
+        if( !data.solution_cache->openFile( data.words[ 2 ] ) ) {
+          data.os << "Unable to open the file '" << data.words[ 2 ] << "'." << std::endl;
+          return EXIT_USAGE_HELP;
+        }
+        return EXIT_OK;
+      }
+      return EXIT_USAGE;
+    }
+
+    int trace( AppData& data ) {
+      if( data.words.size( ) == 2 && data.words[ 1 ] == "off" ) {
+        data.trace.reset( );
+        return EXIT_OK;
+      } else if( data.words.size( ) == 3 && data.words[ 1 ] == "file" ) {
+        std::shared_ptr< ai::Search::TraceFileWriter > writer = std::make_shared< ai::Search::TraceFileWriter >( );
+        if( !writer->Open( data.words[ 2 ] ) ) {
+          data.os << "Unable to open the file '" << data.words[ 2 ] << "'." << std::endl;
+          return EXIT_USAGE_HELP;
+        }
+        data.trace = writer;
+        return EXIT_OK;
+      }
+      return EXIT_USAGE;
+    }
+
     int quit_command( AppData& data ) {
       data.done = true;
       return EXIT_OK;
     }
 
+    /* repeat and foreach are read by process_input_stream_aux, so this
+     * only sees an end outside a block
+     */
+    int end_block( AppData& data ) {
+      data.os << "end without a repeat or foreach." << std::endl;
+      return EXIT_USAGE_HELP;
+    }
+
     void makeActionMap( AppData& data ) {
       data.actions.clear( );
       data.actions[ "echo" ] = { echo, "echo", "echo word*", "Displays the words of its line separated by a single space." };
       data.actions[ "config" ] =  { config, "config", "config option value", "Sets the option to value.  Only predefined options are allowed.  All values are interpreted as floating point.  Changing enable_half or enable_slice will cause the moves to be reset to basic moves, with application of these configurations." };
-      data.actions[ "init" ] =  { init, "init", "init cube|goal solved|cube_configuration+", "Assigns the current state of either the working cube or the goal cube.  Goal cube may contain * for wildcards. May use the solved keyword instead of an actual configuration. A cube_configuration is either 54 facelet symbols, or the name of a defined cube. For goal, more than one configuration may be specified, space separated." };
-      data.actions[ "shuffle" ] =  { shuffle, "shuffle", "shuffle num1 [num2]?", "Randomly applies rotations to the current cube num1 times. If num2 is present, a number in the range [num1, num2] (inclusive) is selected as the number of rotations to apply.  Configured moves are selected with equal probability." };
-      data.actions[ "generate" ] =  { generate_cubes, "generate", "generate depth filename", "Create all unique cubes up to 'depth' steps from the current cube.  Saves the results in 'filename'." };
+      data.actions[ "init" ] =  { init, "init", "init cube|goal|stages solved|cube_configuration+", "Assigns the current state of either the working cube or the goal cube, or the stages used by hla_solve.  Goal cube and stages may contain * for wildcards. May use the solved keyword instead of an actual configuration. A cube_configuration is either 54 facelet symbols, or the name of a defined cube. For goal and stages, more than one configuration may be specified, space separated.  Stages are solved in the order given, and initializing them forgets remembered stage solutions." };
+      data.actions[ "shuffle" ] =  { shuffle, "shuffle", "shuffle num1 [num2]?|uniform [count filename]?", "Randomly applies rotations to the current cube num1 times. If num2 is present, a number in the range [num1, num2] (inclusive) is selected as the number of rotations to apply.  Configured moves are selected with equal probability.  uniform instead rearranges the current cube's corners and edges into an arrangement chosen with equal probability from all those the basic moves can reach.  With count and filename, count such cubes are saved to filename, one per line, and the current cube is unchanged." };
+      data.actions[ "generate" ] =  { generate_cubes, "generate", "generate depth filename text|binary?", "Create all unique cubes up to 'depth' steps from the current cube.  Saves the results in 'filename', as text lines of the cube and its depth, or in the binary state set format with the number of shortest paths to each cube." };
+      data.actions[ "load" ] =  { load, "load", "load filename cubes prefix|table", "Reads a binary state set file written by generate.  cubes defines each cube as a named cube, prefix followed by its number in the file.  table keeps the depth and path count of each cube, see show table." };
       data.actions[ "equal" ] =  { equal, "equal", "equal cube_configuration|solved|goal", "Checks if the current state matches the specified cube configuration, a solved cube, or one of the goal cubes.  If so, displays the string TRUE, if not, displays the string FALSE.  Note that the cube_configuration or the goal cube may contain wildcards, which match anything.  A cube_configuration is either 54 facelet symbols, or the name of a defined cube." };
-      data.actions[ "search" ] =  { search, "search", "search tree|graph astar|bfs|dfs|dl|ids|bl|al|greedy|uc", "Searches for a path from the current cube to the goal cube, which may contain wildcards. Uses the search algorithm and frontier specified. dl and bl require the depth_limit configuration. ids requires the ids_limit configuration. al requires the astar_limit configuration.  All algorithms and frontiers require the generation_limit and storage_limit configurations.  The apply_solution configuration controls whether a solution is applied to the current cube." };
-      data.actions[ "plan" ] =  { plan, "plan", "plan tree|graph astar|bfs|dfs|dl|ids|al|greedy|uc", "Searches for a plan from the current cube to the goal cube. Uses only the defined plan actions.  Uses the search algorithm and frontier specified. dl requires the depth_limit configuration. ids requires the ids_limit configuration. al requires the astar_limit configuration.  All algorithms and frontiers require the generation_limit and storage_limit configurations.  The apply_solution configuration controls whether a solution is applied to the current cube." };
+      data.actions[ "search" ] =  { search, "search", "search auto|tree|graph astar|bfs|dfs|dl|ids|bl|al|greedy|uc", "Searches for a path from the current cube to the goal cube, which may contain wildcards. Uses the search algorithm and frontier specified.  auto estimates the search's size and chooses graph astar, tree al or graph greedy to fit the generation_limit, storage_limit, memory_limit and auto_time_limit configurations, see the manual. dl and bl require the depth_limit configuration. ids requires the ids_limit configuration. al requires the astar_limit configuration.  All algorithms and frontiers require the generation_limit and storage_limit configurations.  The apply_solution configuration controls whether a solution is applied to the current cube." };
+      data.actions[ "plan" ] =  { plan, "plan", "plan auto|tree|graph astar|bfs|dfs|dl|ids|al|greedy|uc", "Searches for a plan from the current cube to the goal cube. Uses only the defined plan actions.  Uses the search algorithm and frontier specified, or chooses them as search auto does. dl requires the depth_limit configuration. ids requires the ids_limit configuration. al requires the astar_limit configuration.  All algorithms and frontiers require the generation_limit and storage_limit configurations.  The apply_solution configuration controls whether a solution is applied to the current cube." };
+      data.actions[ "hla_solve" ] =  { hla_solve, "hla_solve", "hla_solve search|plan tree|graph astar|bfs|dfs|dl|ids|bl|al|greedy|uc", "Solves each of the stages from init stages in order, using search or plan with the algorithm and frontier specified for each stage, without undoing the stages before it.  The solution of each stage is remembered, keyed by the current moves or plan actions and the facelets its stage constrains, and is reused without searching when it also solves a later cube with the same facelets.  The goal cube is not used.  The apply_solution configuration controls whether the combined solution is applied to the current cube." };
+      data.actions[ "batch" ] =  { batch, "batch", "batch filename search|plan tree|graph astar|bfs|dfs|dl|ids|bl|al|greedy|uc", "Solves every cube in filename for the goal cube, using search or plan with the algorithm and frontier specified.  Each line of the file is a cube_configuration, or a sequence of moves applied to the current cube.  Cubes are solved concurrently by the number of worker threads in the threads configuration, 0 meaning one per hardware thread.  Results are displayed in input order, in the machine format followed by the time in seconds.  Solutions are not applied to the current cube." };
+      data.actions[ "profile_heuristic" ] =  { profile_heuristic, "profile_heuristic", "profile_heuristic cost", "Finds the exact cost to the goal of every cube within cost of the goal cubes, which may not contain wildcards, using the current moves backwards from the goal.  Then evaluates each search heuristic on those cubes and displays its mean ratio of heuristic to cost, the cubes it overestimates, the moves between cubes where it drops by more than the move's cost, and the nodes an IDA* iteration to cost is predicted to expand by Korf's formula.  Uses the threads configuration." };
+      data.actions[ "serve" ] =  { serve, "serve", "serve port", "Listens for connections on the loopback interface at port.  Each message received is one or more command lines, processed as if typed, and answered with their output.  Each connection starts from a copy of the current state, with machine solution display and no prompt.  Connections are handled concurrently.  A message of shutdown stops the server." };
+      data.actions[ "cache" ] =  { cache, "cache", "cache clear|file filename", "Manages the solution cache used by search and plan when the solution_cache configuration is enabled.  clear forgets all solutions and counters.  file loads the solutions saved in filename, and appends every new solution to it.  show cache displays the hit counters." };
+      data.actions[ "trace" ] =  { trace, "trace", "trace off|file filename", "Records the expansions of search, plan, hla_solve and batch in filename, for rubiks-trace-summary.  Each record has the fingerprint, path cost, heuristic and depth of the expanded cube, the fingerprint of its parent, and how many children it added and how many duplicates it generated.  Only every trace_sample_interval'th expansion of a search is recorded.  Records are written by a background thread.  off finishes and closes the file." };
       data.actions[ "rotate" ] =  { rotate, "rotate", "rotate [U|U'|L|L'|F|F'|R|R'|B|B'|D|D']+", "Rotates through the given sequence.  The moves must be separated by whitespace." };
       data.actions[ "moves" ] = { moves, "moves", "moves [U|U'|L|L'|F|F'|R|R'|B|B'|D|D']+|basic", "Restricts legal moves to those listed, or the basic 12 moves augmented by enable_half and enable_slice configuration options." };
-      data.actions[ "show" ]   = { show, "show", "show config|cube|goal|moves|defined_moves|defined_cubes|defined_plan_actions", "Displays the requested item." };
+      data.actions[ "show" ]   = { show, "show", "show config|cube|goal|moves|defined_moves|defined_cubes|defined_plan_actions|stages|cache|stats|table", "Displays the requested item." };
       data.actions[ "define" ] = { define, "define", "define cube|move|plan_action object_name object_configuration", "Defines a named object of the specified type.  Cubes are defined by the 54 tile characters.  Spaces and tabs are skipped. Wildcard characters are allowed. Cubes may also be defined by a list of space separated cubes, 54 tile characters or names of defined cubes.  The result is the logical AND of all cubes in the list.  Moves are defined by one or more already defined moves, e.g. F U R U' R' F'.  Plan actions are defined as 'precondition cube1 cube2 ... effect move1 move2 ...' There must be one or more cubes in the precondition, and 1 or more moves in the effect." };
       data.actions[ "help" ] = { help, "help", "help command?", "Displays a list of commands.  If a command is given, only help on that command is displayed." };
-      data.actions[ "run" ] = { run, "run", "run filename", "Runs the commands in filename as if they were typed.  Turns off the prompt while reading the file." };
+      data.actions[ "repeat" ] = { end_block, "repeat", "repeat count", "Reads the lines up to the matching end, then runs them count times.  The lines are read and split into words once.  In them, $iteration is replaced by the iteration number, from 1, and $iterations by count, of the innermost repeat or foreach.  Blocks may be nested.  Afterwards the time of the block and the total time of each of its lines are displayed, with human solution display." };
+      data.actions[ "foreach" ] = { end_block, "foreach", "foreach cube in filename", "Reads the lines up to the matching end, then runs them once for each cube in filename, which is made the current cube.  The current cube is restored afterwards.  Each line of the file is a cube_configuration, or a sequence of moves applied to the current cube, as for batch.  Otherwise as repeat." };
+      data.actions[ "end" ] = { end_block, "end", "end", "Ends a repeat or foreach block." };
+      data.actions[ "run" ] = { run, "run", "run filename", "Runs the commands in filename as if they were typed.  Turns off the prompt while reading the file.  The file works on the same cube, configuration and definitions, so changes it makes remain when it ends, and files may run other files." };
       data.actions[ "exit_if" ] = { exit_if, "exit_if", "exit_if not_equal_goal", "Stops execution if the condition holds." };
       data.actions[ "quit" ] = { quit_command, "quit", "quit", "Exits the program." };
       data.actions[ "exit" ] = { quit_command, "exit", "exit", "Exits the program." };
@@ -765,46 +998,317 @@ namespace cgl {
     /*********************************************
      * Input processing
      */
-    /* Read until newline character or end of file
-     * If the last character of the line (except for the newline) is \, then remove the \ and read the next line.
-     * Store whitespace separated words in output vector
-     * return true if something was read, false if any error occurred, including read after EOF was reached
+    /* Runs data.words with action, reporting usage and help as the
+     * command's exit status asks, or reports an unknown command if
+     * action is null, see find_action.
      */
-    bool read_one_line( std::istream& is, std::vector< std::string >& words ) {
-      words.clear( );
+    static void dispatch_action( AppData& data, const ActionRecord *action ) {
+      if( action ) {
+        const ActionRecord& record = *action;
+        if( data.words.size( ) > record.max_words ) {
+          data.os << "Only the forms of '" << data.words[ 0 ] << "' with at most " << record.max_words << " words are available here." << std::endl;
+          data.os << "usage: " << record.usage << std::endl;
+          return;
+        }
+        int exit_status = record.action( data );
+        switch( exit_status ) {
+        case EXIT_OK:
+          // empty
+          break;
+        case EXIT_USAGE:
+          data.os << "usage: " << record.usage << std::endl;
+          break;
+        case EXIT_HELP:
+          data.os << "help: " << data.words[ 0 ] << " :: ";
+          show_help( data.os, data, 0, record.help );
+          data.os << std::endl;
+          break;
+        case EXIT_USAGE_HELP:
+          data.os << "usage: " << record.usage << std::endl;
+          data.os << "help: " << data.words[ 0 ] << " :: ";
+          show_help( data.os, data, 0, record.help );
+          data.os << std::endl;
+          break;
+        case EXIT_EXIT:
+          data.os << "Early termination of program." << std::endl;
+          data.done = true;
+          break;
+        case EXIT_THROW: 
+          {
+            std::stringstream ss;
+            ss << "Error in command: '" << data.words[ 0 ] << "'.  Exit status " << exit_status << "." << std::endl;
+            ss << "usage: " << record.usage << std::endl;
+            ss << "help: " << record.help << std::endl;
+            ss << "help: " << data.words[ 0 ] << " :: ";
+            show_help( ss, data, 0, record.help );
+            ss << std::endl;
+            
+            throw Exception( ss.str( ) );
+          }
+          break;
+        default:
+          {
+            std::stringstream ss;
+            ss << "Unexpected exit status: " << exit_status << std::endl;
+            ss << "Error in command: '" << data.words[ 0 ] << "'.  Exit status " << exit_status << "." << std::endl;
+            ss << "usage: " << record.usage << std::endl;
+            ss << "help: " << record.help << std::endl;
+            throw Exception( ss.str( ) );
+          }
+          break;
+        }
+        /*
+      } else if ( data.words[ 0 ] == "solve_save" ) { 
+        solve_save_cube( data.cube, data.words, data.config, data.goal_cube );
+      } else if ( data.words[ 0 ] == "save_known_cubes" ) { 
+        save_known_cubes( data.cube, data.words, data.config );
+      } else if ( data.words[ 0 ] == "find" ) { 
+        find( data.cube, data.words );
+      } else if ( data.words[ 0 ] == "dump_known_cubes" ) { 
+        dump_known_cubes( data.cube, data.words, data.config );
+        */
+      } else {
+        /*
+        std::stringstream ss;
+        ss << "Unexpected command: '" << data.words[ 0 ] << "'";
+        throw Exception( ss.str( ) );
+        */
+        data.os << std::endl;
+        data.os << "Unexpected command: '" << data.words[ 0 ] << "'" << std::endl;
+        data.os << "The help command will list all available commands." << std::endl;
+        data.os << std::endl;
+      }
+    }
 
-      bool done = false;
-      while( !done ) {
+    /* the action named by word, or null */
+    static const ActionRecord *find_action( const AppData& data, const std::string& word ) {
+      std::unordered_map< std::string, ActionRecord >::const_iterator action = data.actions.find( word );
+      return action != data.actions.end( ) ? &action->second : 0;
+    }
 
-        std::string line;
-        std::getline( is, line );
-        if ( ! is ) { 
-          return false;
+    static void dispatch_command( AppData& data ) {
+      dispatch_action( data, find_action( data, data.words[ 0 ] ) );
+    }
+
+    /* A line of a repeat or foreach block, tokenized and looked up once
+     * when the block is read.  The first line is the repeat or foreach
+     * itself.
+     */
+    struct BlockLine {
+      std::vector< std::string > words;
+      const ActionRecord *action; // null for an unknown command
+      size_t block_end;  // for repeat and foreach, the index after their end, else 0
+      bool   substitute; // a word contains $
+      double seconds;    // spent in this line, over all iterations
+    };
+
+    /* the counters of the innermost block, for $ substitution */
+    struct BlockCounters {
+      long iteration;    // 1, 2, ...
+      long iterations;
+    };
+
+    /* repeat or foreach, unless data's actions leave them out, see serve */
+    static bool is_block_start( const AppData& data, const std::string& word ) {
+      return ( word == "repeat" || word == "foreach" ) && data.actions.count( word ) > 0;
+    }
+
+    /* Reads lines from is until the end matching the block started by
+     * tokenizer's current line.  Returns false if is ends first.
+     */
+    static bool read_block( const AppData& data, Tokenizer& tokenizer, std::istream& is, std::vector< BlockLine >& lines ) {
+      std::vector< size_t > open_blocks;
+      do {
+        const std::vector< std::string_view >& tokens = tokenizer.getTokens( );
+        if( tokens.empty( ) || tokens[ 0 ][ 0 ] == '#' ) {
+          continue;
+        }
+        if( tokens[ 0 ] == "end" && tokens.size( ) == 1 ) {
+          lines[ open_blocks.back( ) ].block_end = lines.size( ) + 1;
+          open_blocks.pop_back( );
+        }
+        BlockLine line;
+        line.words.assign( tokens.begin( ), tokens.end( ) );
+        line.action = find_action( data, line.words[ 0 ] );
+        line.block_end = 0;
+        line.substitute = false;
+        line.seconds = 0.0;
+        for( auto it = tokens.begin( ); it != tokens.end( ); it++ ) {
+          if( it->find( '$' ) != std::string_view::npos ) {
+            line.substitute = true;
+          }
         }
-  
-        std::stringstream ss( line );
+        if( is_block_start( data, line.words[ 0 ] ) ) {
+          open_blocks.push_back( lines.size( ) );
+        }
+        lines.push_back( line );
+        if( open_blocks.empty( ) ) {
+          return true;
+        }
+      } while( tokenizer.readLine( is ) );
+      return false;
+    }
+
+    /* Replaces $iteration and $iterations in words. */
+    static void substitute_counters( std::vector< std::string >& words, const BlockCounters& counters ) {
+      for( auto it = words.begin( ); it != words.end( ); it++ ) {
         std::string word;
-        while ( ss >> word ) {
-          words.push_back( word );
+        size_t i = 0;
+        while( i < it->size( ) ) {
+          size_t end = i + 1;
+          if( ( *it )[ i ] == '$' ) {
+            while( end < it->size( ) && ( std::isalnum( static_cast< unsigned char >( ( *it )[ end ] ) ) || ( *it )[ end ] == '_' ) ) {
+              end++;
+            }
+            const std::string_view name( it->data( ) + i + 1, end - i - 1 );
+            if( name == "iteration" ) {
+              word += std::to_string( counters.iteration );
+              i = end;
+              continue;
+            } else if( name == "iterations" ) {
+              word += std::to_string( counters.iterations );
+              i = end;
+              continue;
+            }
+          }
+          word.append( *it, i, end - i );
+          i = end;
+        }
+        it->swap( word );
+      }
+    }
+
+    /* Runs the block whose repeat or foreach is lines[ first ], using
+     * its words as they were read.  Returns false if they, or those of
+     * a block nested in it, are not valid.  foreach restores the current
+     * cube when it ends.
+     */
+    static bool run_block( AppData& data, std::vector< BlockLine >& lines, const size_t first ) {
+      const std::vector< std::string >& header = lines[ first ].words;
+      const ActionRecord& record = *lines[ first ].action;
+      long iterations = 0;
+      std::vector< Cube > cubes;
+      if( header[ 0 ] == "repeat" ) {
+        if( header.size( ) != 2 || !parse_number( header[ 1 ], iterations ) || iterations < 0 ) {
+          data.os << "usage: " << record.usage << std::endl;
+          return false;
+        }
+      } else {
+        if( header.size( ) != 4 || header[ 1 ] != "cube" || header[ 2 ] != "in" ) {
+          data.os << "usage: " << record.usage << std::endl;
+          return false;
+        }
+        std::ifstream fin( header[ 3 ] );
+        if( !fin ) {
+          data.os << "Unable to open the file '" << header[ 3 ] << "'." << std::endl;
+          return false;
+        }
+        if( read_cube_file( data, fin, cubes ) != EXIT_OK ) {
+          return false;
+        }
+        iterations = cubes.size( );
+      }
+
+      const size_t last = lines[ first ].block_end - 1; // the end line
+      const Cube saved_cube = data.cube;
+      bool ok = true;
+      BlockCounters counters = { 0, iterations };
+      while( ok && counters.iteration < iterations && !data.done ) {
+        if( !cubes.empty( ) ) {
+          data.cube = cubes[ counters.iteration ];
         }
-        
-        if( words.size( ) > 0 && words[ words.size( ) - 1 ] == "\\" ) {
-          words.pop_back( );
-          done = false;
+        counters.iteration++;
+        size_t i = first + 1;
+        while( ok && i < last && !data.done ) {
+          BlockLine& line = lines[ i ];
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now( );
+          size_t next = i + 1;
+          if( line.block_end > 0 ) {
+            ok = run_block( data, lines, i );
+            next = line.block_end;
+          } else {
+            // reuses the storage of data.words from the last line
+            data.words = line.words;
+            if( line.substitute ) {
+              substitute_counters( data.words, counters );
+            }
+            dispatch_action( data, line.action );
+          }
+          std::chrono::duration< double > seconds = std::chrono::steady_clock::now( ) - start;
+          line.seconds += seconds.count( );
+          i = next;
+        }
+      }
+      if( !cubes.empty( ) ) {
+        data.cube = saved_cube;
+      }
+      return ok;
+    }
+
+    /* The time of each line of lines[ first, last ), except end lines,
+     * indented by depth.
+     */
+    static void show_block_times( AppData& data, const std::vector< BlockLine >& lines, const size_t first, const size_t last, const int depth ) {
+      size_t i = first;
+      while( i < last ) {
+        const BlockLine& line = lines[ i ];
+        data.os << std::fixed << std::setprecision( 6 ) << std::setw( 14 ) << line.seconds
+                << std::string( 2 * depth + 2, ' ' );
+        for( auto it = line.words.begin( ); it != line.words.end( ); it++ ) {
+          data.os << ( it == line.words.begin( ) ? "" : " " ) << *it;
+        }
+        data.os << std::endl;
+        data.os.unsetf( std::ios::floatfield );
+        data.os << std::setprecision( 6 );
+        if( line.block_end > 0 ) {
+          show_block_times( data, lines, i + 1, line.block_end - 1, depth + 1 );
+          i = line.block_end;
         } else {
-          done = true;
+          i++;
         }
       }
+    }
+
+    /* Reads the block started by tokenizer's current line, runs it and
+     * shows how long it and each of its lines took.
+     */
+    static void process_block( AppData& data, Tokenizer& tokenizer, std::istream& is ) {
+      std::vector< BlockLine > lines;
+      if( !read_block( data, tokenizer, is, lines ) ) {
+        data.os << "Missing end for " << lines[ 0 ].words[ 0 ] << "." << std::endl;
+        return;
+      }
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now( );
+      if( !run_block( data, lines, 0 ) ) {
+        return;
+      }
+      std::chrono::duration< double > seconds = std::chrono::steady_clock::now( ) - start;
+      lines[ 0 ].seconds = seconds.count( );
 
-      return true;
+      if( data.config.displaySolutionHuman( ) ) {
+        data.os << "Block seconds:" << std::endl;
+        show_block_times( data, lines, 0, lines.size( ), 0 );
+      }
     }
 
     void process_input_stream_aux( AppData& data ) {
+      process_input_stream_aux( data, data.is );
+    }
+
+    /* Reads command lines from is with a Tokenizer, and runs each
+     * through the action map on data.  A line whose last word is \
+     * continues on the next line.  is need not be data.is, so run can
+     * execute a script on the caller's state without copying it.
+     * repeat and foreach blocks are read to their end, then run.
+     */
+    void process_input_stream_aux( AppData& data, std::istream& is ) {
+      Tokenizer tokenizer;
       
       if( data.config.prompt( ) ) {
         data.os << "cube> " << std::flush;
       }
-      while( ( !data.done ) && read_one_line( data.is, data.words ) ) {
+      while( ( !data.done ) && tokenizer.readLine( is ) ) {
+        tokenizer.assignWords( data.words );
         if ( data.words.size( ) == 0 ) {
           // empty (whitespace only) lines
           continue;
@@ -814,94 +1318,26 @@ namespace cgl {
         } else if ( data.words[ 0 ][ 0 ] == '#' ) {
           // comment lines begin with # as first non-whitespace character
           continue;
-        } else if ( data.actions.count( data.words[ 0 ] ) > 0 ) {
-          int exit_status = data.actions.at( data.words[ 0 ] ).action( data );
-          switch( exit_status ) {
-          case EXIT_OK:
-            // empty
-            break;
-          case EXIT_USAGE:
-            data.os << "usage: " << data.actions.at( data.words[ 0 ] ).usage << std::endl;
-            break;
-          case EXIT_HELP:
-            data.os << "help: " << data.words[ 0 ] << " :: ";
-            show_help( data.os, data, 0, data.actions.at( data.words[ 0 ] ).help );
-            data.os << std::endl;
-            break;
-          case EXIT_USAGE_HELP:
-            data.os << "usage: " << data.actions.at( data.words[ 0 ] ).usage << std::endl;
-            data.os << "help: " << data.words[ 0 ] << " :: ";
-            show_help( data.os, data, 0, data.actions.at( data.words[ 0 ] ).help );
-            data.os << std::endl;
-            break;
-          case EXIT_EXIT:
-            data.os << "Early termination of program." << std::endl;
-            data.done = true;
-            break;
-          case EXIT_THROW: 
-            {
-              std::stringstream ss;
-              ss << "Error in command: '" << data.words[ 0 ] << "'.  Exit status " << exit_status << "." << std::endl;
-              ss << "usage: " << data.actions.at( data.words[ 0 ] ).usage << std::endl;
-              ss << "help: " << data.actions.at( data.words[ 0 ] ).help << std::endl;
-              ss << "help: " << data.words[ 0 ] << " :: ";
-              show_help( ss, data, 0, data.actions.at( data.words[ 0 ] ).help );
-              ss << std::endl;
-              
-              throw Exception( ss.str( ) );
-            }
-            break;
-          default:
-            {
-              std::stringstream ss;
-              ss << "Unexpected exit status: " << exit_status << std::endl;
-              ss << "Error in command: '" << data.words[ 0 ] << "'.  Exit status " << exit_status << "." << std::endl;
-              ss << "usage: " << data.actions.at( data.words[ 0 ] ).usage << std::endl;
-              ss << "help: " << data.actions.at( data.words[ 0 ] ).help << std::endl;
-              throw Exception( ss.str( ) );
-            }
-            break;
-          }
-          /*
-        } else if ( data.words[ 0 ] == "hla_solve" ) { 
-          hla_solve_cube( data );
-        } else if ( data.words[ 0 ] == "solve_save" ) { 
-          solve_save_cube( data.cube, data.words, data.config, data.goal_cube );
-        } else if ( data.words[ 0 ] == "save_known_cubes" ) { 
-          save_known_cubes( data.cube, data.words, data.config );
-        } else if ( data.words[ 0 ] == "repeat" ) { 
-          repeat_file( data );
-        } else if ( data.words[ 0 ] == "find" ) { 
-          find( data.cube, data.words );
-        } else if ( data.words[ 0 ] == "dump_known_cubes" ) { 
-          dump_known_cubes( data.cube, data.words, data.config );
-          */
+        } else if ( is_block_start( data, data.words[ 0 ] ) ) {
+          process_block( data, tokenizer, is );
         } else {
-          /*
-          std::stringstream ss;
-          ss << "Unexpected command: '" << data.words[ 0 ] << "'";
-          throw Exception( ss.str( ) );
-          */
-          data.os << std::endl;
-          data.os << "Unexpected command: '" << data.words[ 0 ] << "'" << std::endl;
-          data.os << "The help command will list all available commands." << std::endl;
-          data.os << std::endl;
+          dispatch_command( data );
         }
         if( data.config.prompt( ) ) {
           data.os << "cube> ";
         }
-        data.os << std::flush;
+        // only flush before a read that may wait, so a script does not
+        // cost one write per line while a person or pipe still sees replies
+        if( is.rdbuf( )->in_avail( ) <= 0 ) {
+          data.os << std::flush;
+        }
       }
+      data.os << std::flush;
     }
 
 
     // "main" program control
     void process_input_stream( std::istream& is, std::ostream& os, bool is_tty ) {
-      /* srand seeds at 100 usecond resolution */
-      struct timeval time;
-      gettimeofday(&time,NULL);
-      srand((time.tv_sec * 10000) + (time.tv_usec / 100));
-      
       AppData data( is, os );
       if( !is_tty ) {
         data.config.disablePrompt( );
@@ -918,6 +1354,8 @@ namespace cgl {
 }
 
 int main( ) {
+  /* lets cin read whole blocks, instead of a character at a time through stdio */
+  std::ios::sync_with_stdio( false );
   cgl::rubiks::process_input_stream( std::cin, std::cout, isatty( fileno( stdin ) ) );
   return 0;
 }
@@ -101,8 +101,8 @@ namespace cgl {
       return mMoves.at( move_name );
     }
 
-    const Move& MoveSet::getRandomMove( ) const {
-      int index = std::rand( ) % mKeys.size( );
+    const Move& MoveSet::getRandomMove( Random& random ) const {
+      int index = random.below( mKeys.size( ) );
       return getMove( mKeys[ index ] );
     }
 
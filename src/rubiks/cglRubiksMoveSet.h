@@ -2,6 +2,7 @@
 #define _CGLRUBIKSMOVESET_H_
 
 #include "cglRubiksCube.h"
+#include "cglRubiksRandom.h"
 #include <string>
 #include <vector>
 #include <map>
@@ -22,7 +23,7 @@ namespace cgl {
       const std::map< std::string, Move >& getMoves( ) const;
       bool moveExists( const std::string& move_name ) const;
       const Move& getMove( const std::string& move_name ) const;
-      const Move& getRandomMove( ) const;
+      const Move& getRandomMove( Random& random ) const;
 
       bool moveIsDefined( const std::string& name ) const;
       int  defineMove( const std::string& name, const Move& move );
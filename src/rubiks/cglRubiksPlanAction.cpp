@@ -1,5 +1,7 @@
 #include "cglRubiksPlanAction.h"
 #include "cglRubiksCommand.h"
+#include <algorithm>
+#include <queue>
 
 namespace cgl {
   namespace rubiks {
@@ -20,19 +22,22 @@ namespace cgl {
 
     PlanAction::PlanAction( const std::string& name, const std::vector< Cube >& preconditions, const Move& effect ) 
       : mName( name ), mPreconditions( preconditions ), mEffect( effect ) {
-      // empty
+      compilePreconditions( );
     }
 
     void PlanAction::clearPreconditions( ) {
       mPreconditions.clear( );
+      compilePreconditions( );
     }
 
     void PlanAction::setPreconditions( const std::vector< Cube >& preconditions ) {
       mPreconditions = preconditions;
+      compilePreconditions( );
     }
 
     void PlanAction::addPrecondition( const Cube& precondition ) {
       mPreconditions.push_back( precondition );
+      mCompiledPreconditions.push_back( FaceletPattern( precondition ) );
     }
 
     void PlanAction::setEffect( const Move& effect ) {
@@ -50,6 +55,10 @@ namespace cgl {
     const Move& PlanAction::getEffect( ) const {
       return mEffect;
     }
+
+    const std::vector< FaceletPattern >& PlanAction::getCompiledPreconditions( ) const {
+      return mCompiledPreconditions;
+    }
     
     bool PlanAction::conditionsAreMet( const Cube& cube ) const {
       bool eq = true;
@@ -59,6 +68,31 @@ namespace cgl {
       return eq;
     }
 
+    bool PlanAction::conditionsAreMet( const PackedCube& cube ) const {
+      for( auto it = mCompiledPreconditions.begin( ); it != mCompiledPreconditions.end( ); it++ ) {
+        if( !it->matches( cube ) ) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    Facelet PlanAction::getRequiredFacelet( const int position ) const {
+      for( auto it = mCompiledPreconditions.begin( ); it != mCompiledPreconditions.end( ); it++ ) {
+        if( it->constrains( position ) ) {
+          return it->getFacelet( position );
+        }
+      }
+      return '*';
+    }
+
+    void PlanAction::compilePreconditions( ) {
+      mCompiledPreconditions.clear( );
+      for( auto it = mPreconditions.begin( ); it != mPreconditions.end( ); it++ ) {
+        mCompiledPreconditions.push_back( FaceletPattern( *it ) );
+      }
+    }
+
     /*
      * PlanAction
      ************************************************************************/
@@ -67,12 +101,58 @@ namespace cgl {
      * PlanActionSet
      */
 
-    PlanActionSet::PlanActionSet( ) {
-      // empty
+    /* Nodes with at most this many actions are not split further. */
+    static const unsigned int INDEX_LEAF_SIZE = 4;
+    static const int INDEX_MAX_DEPTH = 8;
+
+    PlanActionSet::PlanActionSet( )
+      : mBuilt( false ) {
+      actionsChanged( );
+    }
+
+    PlanActionSet::PlanActionSet( const PlanActionSet& rhs )
+      : mActions( rhs.mActions ), mBuilt( false ) {
+      copyBuilt( rhs );
+    }
+
+    PlanActionSet& PlanActionSet::operator=( const PlanActionSet& rhs ) {
+      if( this != &rhs ) {
+        mActions = rhs.mActions;
+        copyBuilt( rhs );
+      }
+      return *this;
+    }
+
+    /* Takes rhs's tables if it has built them, pointing the index at
+     * this set's copies of the actions.  Otherwise they are built when
+     * needed.
+     */
+    void PlanActionSet::copyBuilt( const PlanActionSet& rhs ) {
+      actionsChanged( );
+      std::lock_guard< std::mutex > lock( rhs.mBuildMutex );
+      if( !rhs.mBuilt ) {
+        return;
+      }
+      std::map< const PlanAction *, const PlanAction * > copies;
+      auto mine = mActions.begin( );
+      for( auto it = rhs.mActions.begin( ); it != rhs.mActions.end( ); it++, mine++ ) {
+        copies[ &( it->second ) ] = &( mine->second );
+      }
+      mIndex = rhs.mIndex;
+      for( auto node = mIndex.begin( ); node != mIndex.end( ); node++ ) {
+        for( auto it = node->actions.begin( ); it != node->actions.end( ); it++ ) {
+          *it = copies.at( *it );
+        }
+      }
+      mFaceletDistance = rhs.mFaceletDistance;
+      mMaxMovedFacelets = rhs.mMaxMovedFacelets;
+      mMinActionCost = rhs.mMinActionCost;
+      mBuilt = true;
     }
 
     void PlanActionSet::clearDefinedActions( ) {
       mActions.clear( );
+      actionsChanged( );
     }
 
     int PlanActionSet::defineAction( const std::string& action_name, const PlanAction& action ) {
@@ -80,6 +160,7 @@ namespace cgl {
         return EXIT_USAGE;
       }
       mActions[ action_name ] = action;
+      actionsChanged( );
       return EXIT_OK;
     }
 
@@ -95,6 +176,179 @@ namespace cgl {
       return mActions.at( action_name );
     }
 
+    void PlanActionSet::findCandidateActions( const PackedCube& cube, std::vector< const PlanAction * >& candidates ) const {
+      build( );
+      findCandidateActions( 0, cube, candidates );
+    }
+
+    void PlanActionSet::findCandidateActions( const int node_index, const PackedCube& cube, std::vector< const PlanAction * >& candidates ) const {
+      const IndexNode& node = mIndex[ node_index ];
+      candidates.insert( candidates.end( ), node.actions.begin( ), node.actions.end( ) );
+      if( node.position < 0 ) {
+        return;
+      }
+      Facelet f = cube.getFacelet( node.position );
+      if( f == '*' ) {
+        /* wildcard in the cube matches every child */
+        for( auto it = node.children.begin( ); it != node.children.end( ); it++ ) {
+          if( *it >= 0 ) {
+            findCandidateActions( *it, cube, candidates );
+          }
+        }
+      } else {
+        int child = node.children[ static_cast< unsigned char >( f ) ];
+        if( child >= 0 ) {
+          findCandidateActions( child, cube, candidates );
+        }
+      }
+    }
+
+    int PlanActionSet::getFaceletDistance( const int from, const int to ) const {
+      build( );
+      return mFaceletDistance[ from * NUM_POSITIONS_TOTAL + to ];
+    }
+
+    int PlanActionSet::getMaxMovedFacelets( ) const {
+      build( );
+      return mMaxMovedFacelets;
+    }
+
+    double PlanActionSet::getMinActionCost( ) const {
+      build( );
+      return mMinActionCost;
+    }
+
+    void PlanActionSet::actionsChanged( ) {
+      mBuilt = false;
+      mIndex.clear( );
+      mFaceletDistance.clear( );
+      mMaxMovedFacelets = 0;
+      mMinActionCost = 0.0;
+    }
+
+    void PlanActionSet::build( ) const {
+      if( mBuilt.load( std::memory_order_acquire ) ) {
+        return;
+      }
+      std::lock_guard< std::mutex > lock( mBuildMutex );
+      if( !mBuilt.load( std::memory_order_relaxed ) ) {
+        buildIndex( );
+        buildDistanceTable( );
+        mBuilt.store( true, std::memory_order_release );
+      }
+    }
+
+    /* Breadth first search from each position, over the positions the
+     * effects send a facelet to.
+     */
+    void PlanActionSet::buildDistanceTable( ) const {
+      mFaceletDistance.assign( NUM_POSITIONS_TOTAL * NUM_POSITIONS_TOTAL, -1 );
+      mMaxMovedFacelets = 0;
+      mMinActionCost = 0.0;
+
+      bool first = true;
+      for( auto it = mActions.begin( ); it != mActions.end( ); it++ ) {
+        const Move& effect = it->second.getEffect( );
+        const std::vector< int >& transform = effect.getTransform( );
+        int moved = 0;
+        int i;
+        for( i = 0; i < NUM_POSITIONS_TOTAL; i++ ) {
+          if( transform[ i ] != i ) {
+            moved++;
+          }
+        }
+        mMaxMovedFacelets = std::max( mMaxMovedFacelets, moved );
+        if( first || effect.getCost( ) < mMinActionCost ) {
+          mMinActionCost = effect.getCost( );
+          first = false;
+        }
+      }
+
+      int from;
+      for( from = 0; from < NUM_POSITIONS_TOTAL; from++ ) {
+        int *distance = &mFaceletDistance[ from * NUM_POSITIONS_TOTAL ];
+        std::queue< int > positions;
+        distance[ from ] = 0;
+        positions.push( from );
+        while( !positions.empty( ) ) {
+          int position = positions.front( );
+          positions.pop( );
+          for( auto it = mActions.begin( ); it != mActions.end( ); it++ ) {
+            int to = it->second.getEffect( ).getTransform( )[ position ];
+            if( distance[ to ] < 0 ) {
+              distance[ to ] = distance[ position ] + 1;
+              positions.push( to );
+            }
+          }
+        }
+      }
+    }
+
+    void PlanActionSet::buildIndex( ) const {
+      mIndex.clear( );
+      std::vector< const PlanAction * > actions;
+      for( auto it = mActions.begin( ); it != mActions.end( ); it++ ) {
+        actions.push_back( &( it->second ) );
+      }
+      std::vector< bool > used_positions( NUM_POSITIONS_TOTAL, false );
+      buildIndexNode( actions, used_positions, 0 );
+    }
+
+    int PlanActionSet::buildIndexNode( const std::vector< const PlanAction * >& actions, std::vector< bool >& used_positions, const int depth ) const {
+      int node_index = mIndex.size( );
+      mIndex.push_back( IndexNode( ) );
+      mIndex[ node_index ].position = -1;
+
+      /* choose the position constrained by the most actions */
+      int best_position = -1;
+      unsigned int best_count = 0;
+      if( actions.size( ) > INDEX_LEAF_SIZE && depth < INDEX_MAX_DEPTH ) {
+        int p;
+        for( p = 0; p < NUM_POSITIONS_TOTAL; p++ ) {
+          if( used_positions[ p ] ) {
+            continue;
+          }
+          unsigned int count = std::count_if( actions.begin( ), actions.end( ),
+                                              [p]( const PlanAction *action ) { return action->getRequiredFacelet( p ) != '*'; } );
+          if( count > best_count ) {
+            best_count = count;
+            best_position = p;
+          }
+        }
+      }
+      if( best_count < 2 ) {
+        mIndex[ node_index ].actions = actions;
+        return node_index;
+      }
+
+      std::vector< std::vector< const PlanAction * > > buckets( 256 );
+      std::vector< const PlanAction * > unconstrained;
+      for( auto it = actions.begin( ); it != actions.end( ); it++ ) {
+        Facelet f = ( *it )->getRequiredFacelet( best_position );
+        if( f == '*' ) {
+          unconstrained.push_back( *it );
+        } else {
+          buckets[ static_cast< unsigned char >( f ) ].push_back( *it );
+        }
+      }
+
+      used_positions[ best_position ] = true;
+      std::vector< int > children( 256, -1 );
+      unsigned int i;
+      for( i = 0; i < buckets.size( ); i++ ) {
+        if( buckets[ i ].size( ) > 0 ) {
+          children[ i ] = buildIndexNode( buckets[ i ], used_positions, depth + 1 );
+        }
+      }
+      used_positions[ best_position ] = false;
+
+      /* mIndex may have been reallocated by the recursion */
+      mIndex[ node_index ].position = best_position;
+      mIndex[ node_index ].actions = unconstrained;
+      mIndex[ node_index ].children = children;
+      return node_index;
+    }
+
     /*
      * PlanActionSet
      ************************************************************************/
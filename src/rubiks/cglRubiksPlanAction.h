@@ -2,9 +2,12 @@
 #define _CGLRUBIKSPLANACTION_H_
 
 #include "cglRubiksCube.h"
+#include "cglRubiksFaceletPattern.h"
 #include <string>
 #include <vector>
 #include <map>
+#include <atomic>
+#include <mutex>
 
 namespace cgl {
   namespace rubiks {
@@ -26,13 +29,22 @@ namespace cgl {
       const std::string& getName( ) const;
       const std::vector< Cube >& getPreconditions( ) const;
       const Move& getEffect( ) const;
+      const std::vector< FaceletPattern >& getCompiledPreconditions( ) const;
 
       bool conditionsAreMet( const Cube& cube ) const;
+      bool conditionsAreMet( const PackedCube& cube ) const;
+
+      // the facelet required at position by the preconditions, or '*'
+      Facelet getRequiredFacelet( const int position ) const;
 
     protected:
+      void compilePreconditions( );
+
       std::string         mName;
       std::vector< Cube > mPreconditions;
       Move                mEffect;
+      // mPreconditions as mask/value pairs, kept in sync by every setter
+      std::vector< FaceletPattern > mCompiledPreconditions;
 
     private:
     };
@@ -48,14 +60,60 @@ namespace cgl {
     class PlanActionSet {
     public:
       PlanActionSet( );
+      PlanActionSet( const PlanActionSet& rhs );
+      PlanActionSet& operator=( const PlanActionSet& rhs );
       void clearDefinedActions( );
       int defineAction( const std::string& action_name, const PlanAction& action );
       const std::map< std::string, PlanAction >& getDefinedActions( ) const;
       bool actionIsDefined( const std::string& action_name ) const;
       const PlanAction& getDefinedAction( const std::string& action_name ) const;
+
+      /* Appends the actions that might have their conditions met by cube.
+       * Only these need to be tested with conditionsAreMet( ).
+       *
+       * The index and the effect summaries below are built by the first
+       * call that needs them after the actions change, so defining many
+       * actions does not rebuild them each time.  Building is locked, so
+       * threads may share a const PlanActionSet.
+       */
+      void findCandidateActions( const PackedCube& cube, std::vector< const PlanAction * >& candidates ) const;
+
+      /* Summaries of the effects, ignoring preconditions, for plan heuristics.
+       * getFaceletDistance is the fewest actions that move the facelet at
+       * position from to position to, or -1 if no sequence does.
+       */
+      int getFaceletDistance( const int from, const int to ) const;
+      int getMaxMovedFacelets( ) const;
+      double getMinActionCost( ) const;
       
     protected:
+      void actionsChanged( );
+      void build( ) const;
+      void buildDistanceTable( ) const;
+
+      /*
+       * Discrimination index over the actions.  An internal node splits on the
+       * facelet position most often constrained by its actions.  Actions that
+       * do not constrain that position stay in the node, the rest move to the
+       * child for their required facelet.  Leaves hold the remaining actions.
+       */
+      struct IndexNode {
+        int position; // -1 for leaves
+        std::vector< const PlanAction * > actions;
+        std::vector< int > children; // node index by facelet, -1 if none
+      };
+      void buildIndex( ) const;
+      int  buildIndexNode( const std::vector< const PlanAction * >& actions, std::vector< bool >& used_positions, const int depth ) const;
+      void copyBuilt( const PlanActionSet& rhs );
+      void findCandidateActions( const int node_index, const PackedCube& cube, std::vector< const PlanAction * >& candidates ) const;
+
       std::map< std::string, PlanAction > mActions;
+      mutable std::mutex         mBuildMutex;
+      mutable std::atomic< bool > mBuilt;
+      mutable std::vector< IndexNode > mIndex;
+      mutable std::vector< int > mFaceletDistance; // NUM_POSITIONS_TOTAL x NUM_POSITIONS_TOTAL
+      mutable int    mMaxMovedFacelets;
+      mutable double mMinActionCost;
 
     private:
       
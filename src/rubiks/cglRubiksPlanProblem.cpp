@@ -2,8 +2,8 @@
 #include <cstdlib>
 #include <algorithm>
 #include <map>
-#include <random>
-#include <chrono>
+#include <cmath>
+#include <limits>
 
 
 namespace cgl {
@@ -12,8 +12,20 @@ namespace cgl {
     PlanProblem::PlanProblem( ai::Search::State *initial_state_in, const PlanActionSet& action_set, const std::vector< Cube >& goal_cube_in )
       : ai::Search::Problem( initial_state_in ),
       mGoalCubes( goal_cube_in ), 
-      mActionSet( action_set ) {
-      // empty
+      mGoalIndex( goal_cube_in ),
+      mActionSet( action_set ),
+      mHeuristic( cgl::rubiks::Problem::ZERO_HEURISTIC ) {
+      buildHeuristicPipeline( );
+    }
+
+    PlanProblem::PlanProblem( const PlanProblem& rhs )
+      : ai::Search::Problem( rhs ),
+      mGoalCubes( rhs.mGoalCubes ),
+      mGoalIndex( rhs.mGoalIndex ),
+      mActionSet( rhs.mActionSet ),
+      mHeuristic( rhs.mHeuristic ),
+      mRandom( rhs.mRandom ) {
+      buildHeuristicPipeline( );
     }
 
     PlanProblem::~PlanProblem( ) {
@@ -22,25 +34,21 @@ namespace cgl {
     
     bool PlanProblem::GoalTest( const ai::Search::State * const state_in ) const {
       const State * const state = dynamic_cast< const State * const >( state_in );
-      for( auto it = mGoalCubes.begin( ); it != mGoalCubes.end( ); it++ ) {
-        if( state->getCube( ) == *it ) {
-          return true;
-        }
-      }
-      return false;
+      return mGoalIndex.matches( state->getCube( ) );
     }
 
     std::vector<ai::Search::Action *> PlanProblem::Actions( const ai::Search::State * const state_in ) {
       const State * const state = dynamic_cast< const State * const >( state_in );
-      const Cube& cube = state->getCube( );
-      const std::map< std::string, PlanAction >& plan_actions = mActionSet.getDefinedActions( );
+      const PackedCube cube( state->getCube( ) );
+      std::vector< const PlanAction * > candidates;
+      mActionSet.findCandidateActions( cube, candidates );
       std::vector<ai::Search::Action *> actions;
-      for( auto it = plan_actions.begin( ); it != plan_actions.end( ); it++ ) {
-        if( it->second.conditionsAreMet( cube ) ) {
-          actions.push_back( new Action( it->second.getEffect( ) ) );
+      for( auto it = candidates.begin( ); it != candidates.end( ); it++ ) {
+        if( ( *it )->conditionsAreMet( cube ) ) {
+          actions.push_back( new Action( ( *it )->getEffect( ) ) );
         }
       }
-      std::shuffle( actions.begin( ), actions.end( ), std::default_random_engine(std::chrono::steady_clock::now().time_since_epoch().count()) );
+      std::shuffle( actions.begin( ), actions.end( ), mRandom );
       return actions;
     }
     
@@ -58,15 +66,123 @@ namespace cgl {
       return action->getMove( ).getCost( );
     }
 
-    double PlanProblem::Heuristic(const ai::Search::State  * const /*state_in*/) const {
-      //const State * const state = dynamic_cast< const State * const >( state_in );
-      double h = 0.0;
-      return h;
+    double PlanProblem::Heuristic(const ai::Search::State  * const state_in) const {
+      return mHeuristicPipeline.evaluate( state_in );
+    }
+
+    double PlanProblem::BoundedHeuristic(const ai::Search::State  * const state_in, double bound_in) const {
+      return mHeuristicPipeline.evaluate( state_in, bound_in );
     }
 
     const std::vector< Cube >& PlanProblem::getGoalCubes( ) const {
       return mGoalCubes;
     }
+
+    cgl::rubiks::Problem::HeuristicEnum PlanProblem::getHeuristic( ) const {
+      return mHeuristic;
+    }
+
+    void PlanProblem::seedRandom( const std::uint64_t seed ) {
+      mRandom.seed( seed );
+    }
+
+    void PlanProblem::setHeuristic( const cgl::rubiks::Problem::HeuristicEnum& heuristic ) {
+      mHeuristic = heuristic;
+      buildHeuristicPipeline( );
+    }
+
+    void PlanProblem::displayHeuristicStats( std::ostream& os ) const {
+      mHeuristicPipeline.displayStats( os );
+    }
+
+    void PlanProblem::buildHeuristicPipeline( ) {
+      mHeuristicPipeline.clear( );
+      mHeuristicPipeline.setCombine( HeuristicPipeline::COMBINE_MAX );
+      switch( mHeuristic ) {
+      case cgl::rubiks::Problem::PLAN_FACELET_HEURISTIC:
+        mHeuristicPipeline.addComponent( "plan_facelet", [this]( const ai::Search::State * const state_in ) { return planFaceletHeuristic( state_in ); }, 54.0 );
+        break;
+      case cgl::rubiks::Problem::PLAN_DISTANCE_HEURISTIC:
+        mHeuristicPipeline.addComponent( "plan_distance", [this]( const ai::Search::State * const state_in ) { return planDistanceHeuristic( state_in ); }, 54.0 * 54.0 );
+        break;
+      default:
+        mHeuristicPipeline.addComponent( "zero", [this]( const ai::Search::State * const state_in ) { return zeroHeuristic( state_in ); }, 0.0 );
+        break;
+      }
+    }
+
+    double PlanProblem::zeroHeuristic(const ai::Search::State  * const /*state_in*/) const {
+      return 0.0;
+    }
+
+    /* Each action changes at most getMaxMovedFacelets( ) facelets, so at
+     * least mismatched / moved actions are needed, each costing at least
+     * getMinActionCost( ).
+     */
+    double PlanProblem::planFaceletHeuristic(const ai::Search::State  * const state_in) const {
+      const State * const state = dynamic_cast< const State * const >( state_in );
+      const std::vector< Facelet >& cube = state->getCube( ).getFacelets( );
+
+      double best_count = std::numeric_limits< double >::infinity( );
+      for( auto it = mGoalCubes.begin( ); it != mGoalCubes.end( ); it++ ) {
+        const std::vector< Facelet >& goal = it->getFacelets( );
+        double count = 0.0;
+        unsigned int i;
+        for( i = 0; i < cube.size( ); i++ ) {
+          if( goal[ i ] != '*' && cube[ i ] != '*' && cube[ i ] != goal[ i ] ) {
+            count += 1.0;
+          }
+        }
+        if( count < best_count ) {
+          best_count = count;
+        }
+      }
+      if( best_count == 0.0 ) {
+        return 0.0;
+      }
+      int moved = mActionSet.getMaxMovedFacelets( );
+      if( moved == 0 ) {
+        return std::numeric_limits< double >::infinity( );
+      }
+      return std::ceil( best_count / moved ) * mActionSet.getMinActionCost( );
+    }
+
+    /* A goal facelet must be filled by a facelet of its color, which needs
+     * at least the relaxed distance from the nearest such facelet.  The
+     * farthest goal facelet bounds the number of actions.
+     */
+    double PlanProblem::planDistanceHeuristic(const ai::Search::State  * const state_in) const {
+      const State * const state = dynamic_cast< const State * const >( state_in );
+      const std::vector< Facelet >& cube = state->getCube( ).getFacelets( );
+
+      int best_actions = std::numeric_limits< int >::max( );
+      for( auto it = mGoalCubes.begin( ); it != mGoalCubes.end( ); it++ ) {
+        const std::vector< Facelet >& goal = it->getFacelets( );
+        int actions = 0;
+        int to;
+        for( to = 0; to < NUM_POSITIONS_TOTAL && actions < best_actions; to++ ) {
+          if( goal[ to ] == '*' || cube[ to ] == '*' || cube[ to ] == goal[ to ] ) {
+            continue;
+          }
+          int nearest = std::numeric_limits< int >::max( );
+          int from;
+          for( from = 0; from < NUM_POSITIONS_TOTAL; from++ ) {
+            if( cube[ from ] == goal[ to ] || cube[ from ] == '*' ) {
+              int distance = mActionSet.getFaceletDistance( from, to );
+              if( distance >= 0 && distance < nearest ) {
+                nearest = distance;
+              }
+            }
+          }
+          actions = std::max( actions, nearest );
+        }
+        best_actions = std::min( best_actions, actions );
+      }
+      if( best_actions == std::numeric_limits< int >::max( ) ) {
+        return std::numeric_limits< double >::infinity( );
+      }
+      return best_actions * mActionSet.getMinActionCost( );
+    }
     
   }
 }
@@ -5,6 +5,10 @@
 #include "cglRubiksAction.h"
 #include "cglRubiksState.h"
 #include "cglRubiksPlanAction.h"
+#include "cglRubiksProblem.h"
+#include "cglRubiksHeuristic.h"
+#include "cglRubiksGoalIndex.h"
+#include "cglRubiksRandom.h"
 #include <map>
 #include <vector>
 #include <string>
@@ -16,6 +20,9 @@ namespace cgl {
     public:
   
       PlanProblem( ai::Search::State *initial_state_in, const PlanActionSet& action_set, const std::vector< Cube >& goal_cubes_in );
+      // the pipeline's components call back into their PlanProblem, so
+      // copies build their own.  Not assignable, as mActionSet is a reference.
+      PlanProblem( const PlanProblem& rhs );
       virtual ~PlanProblem( );
 
       virtual bool GoalTest( const ai::Search::State * const state_in ) const;
@@ -27,12 +34,31 @@ namespace cgl {
                                const ai::Search::State  * const state2_in ) const;
 
       virtual double Heuristic(const ai::Search::State  * const state_in) const;
+      virtual double BoundedHeuristic(const ai::Search::State  * const state_in, double bound_in) const;
 
       const std::vector< Cube >& getGoalCubes( ) const;
 
+      /* Only the plan heuristics are meaningful for plan actions,
+       * all others use the zero heuristic.
+       */
+      cgl::rubiks::Problem::HeuristicEnum getHeuristic( ) const;
+      void setHeuristic( const cgl::rubiks::Problem::HeuristicEnum& heuristic );
+      // seeds the order Actions( ) returns actions in
+      void seedRandom( const std::uint64_t seed );
+      void displayHeuristicStats( std::ostream& os ) const;
+
     protected:
+      void buildHeuristicPipeline( );
+      double zeroHeuristic(const ai::Search::State  * const state_in) const;
+      double planFaceletHeuristic(const ai::Search::State  * const state_in) const;
+      double planDistanceHeuristic(const ai::Search::State  * const state_in) const;
+
       std::vector< Cube > mGoalCubes;
+      GoalIndex mGoalIndex;
       const PlanActionSet& mActionSet;
+      cgl::rubiks::Problem::HeuristicEnum mHeuristic;
+      HeuristicPipeline mHeuristicPipeline;
+      Random mRandom;
 
     private:
       
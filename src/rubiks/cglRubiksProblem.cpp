@@ -2,8 +2,6 @@
 #include <cstdlib>
 #include <algorithm>
 #include <map>
-#include <random>
-#include <chrono>
 
 
 namespace cgl {
@@ -11,9 +9,35 @@ namespace cgl {
 
     Problem::Problem( ai::Search::State *initial_state_in, const std::vector< Cube >& goal_cube_in )
       : ai::Search::Problem( initial_state_in ), mGoalCubes( goal_cube_in ),
+        mGoalIndex( goal_cube_in ),
         mHalfTurns( false ), mSliceTurns( false ),
         mHeuristic( FACELET_HEURISTIC ) {
-      // empty
+      buildHeuristicPipeline( );
+    }
+
+    Problem::Problem( const Problem& rhs )
+      : ai::Search::Problem( rhs ), mGoalCubes( rhs.mGoalCubes ),
+        mGoalIndex( rhs.mGoalIndex ),
+        mHalfTurns( rhs.mHalfTurns ), mSliceTurns( rhs.mSliceTurns ),
+        mAllowedMoves( rhs.mAllowedMoves ),
+        mHeuristic( rhs.mHeuristic ),
+        mRandom( rhs.mRandom ) {
+      buildHeuristicPipeline( );
+    }
+
+    Problem& Problem::operator=( const Problem& rhs ) {
+      if( this != &rhs ) {
+        ai::Search::Problem::operator=( rhs );
+        mGoalCubes = rhs.mGoalCubes;
+        mGoalIndex = rhs.mGoalIndex;
+        mHalfTurns = rhs.mHalfTurns;
+        mSliceTurns = rhs.mSliceTurns;
+        mAllowedMoves = rhs.mAllowedMoves;
+        mHeuristic = rhs.mHeuristic;
+        mRandom = rhs.mRandom;
+        buildHeuristicPipeline( );
+      }
+      return *this;
     }
 
     Problem::~Problem( ) {
@@ -22,12 +46,7 @@ namespace cgl {
     
     bool Problem::GoalTest( const ai::Search::State * const state_in ) const {
       const State * const state = dynamic_cast< const State * const >( state_in );
-      for( auto it = mGoalCubes.begin( ); it != mGoalCubes.end( ); it++ ) {
-        if( state->getCube( ) == *it ) {
-          return true;
-        }
-      }
-      return false;
+      return mGoalIndex.matches( state->getCube( ) );
     }
 
     std::vector<ai::Search::Action *> Problem::Actions( const ai::Search::State * const /*state_in*/ ) {
@@ -85,7 +104,7 @@ namespace cgl {
         }
       }
       
-      std::shuffle( actions.begin( ), actions.end( ), std::default_random_engine(std::chrono::steady_clock::now().time_since_epoch().count()) );
+      std::shuffle( actions.begin( ), actions.end( ), mRandom );
       return actions;
     }
     
@@ -104,30 +123,11 @@ namespace cgl {
     }
 
     double Problem::Heuristic(const ai::Search::State  * const state_in) const {
-      //const State * const state = dynamic_cast< const State * const >( state_in );
-      double h = 0.0;
-      switch( mHeuristic ) {
-      case ZERO_HEURISTIC:
-      default: // fall through
-        h = zeroHeuristic( state_in );
-        break;
-      case FACELET_HEURISTIC:
-        h = faceletHeuristic( state_in );
-        break;
-      case EDGE_FACELET_HEURISTIC:
-        h = edgeFaceletHeuristic( state_in );
-        break;
-      case CORNER_FACELET_HEURISTIC:
-        h = cornerFaceletHeuristic( state_in );
-        break;
-      case FACELET_MAX_HEURISTIC:
-        h = faceletMaxHeuristic( state_in );
-        break;
-      case COLOR_COUNT_HEURISTIC:
-        h = colorCountHeuristic( state_in );
-        break;
-      }
-      return h;
+      return mHeuristicPipeline.evaluate( state_in );
+    }
+
+    double Problem::BoundedHeuristic(const ai::Search::State  * const state_in, double bound_in) const {
+      return mHeuristicPipeline.evaluate( state_in, bound_in );
     }
 
     const std::vector< Cube >& Problem::getGoalCubes( ) const {
@@ -158,88 +158,88 @@ namespace cgl {
       return mHeuristic;
     }
     
+    void Problem::seedRandom( const std::uint64_t seed ) {
+      mRandom.seed( seed );
+    }
+
     void Problem::setHeuristic( const HeuristicEnum& heuristic ) {
       mHeuristic = heuristic;
+      buildHeuristicPipeline( );
     }
 
     void Problem::setAllowedMoves( const std::map< std::string, Move >& allowed_moves ) {
       mAllowedMoves = allowed_moves;
     }
 
+    const HeuristicPipeline& Problem::getHeuristicPipeline( ) const {
+      return mHeuristicPipeline;
+    }
+
+    void Problem::displayHeuristicStats( std::ostream& os ) const {
+      mHeuristicPipeline.displayStats( os );
+    }
+
+    /* Relative costs are roughly the number of facelets examined per goal cube.
+     * Components with equal cost keep the order they are added.
+     */
+    void Problem::buildHeuristicPipeline( ) {
+      mHeuristicPipeline.clear( );
+      mHeuristicPipeline.setCombine( HeuristicPipeline::COMBINE_MAX );
+      switch( mHeuristic ) {
+      case ZERO_HEURISTIC:
+      default: // fall through
+        mHeuristicPipeline.addComponent( "zero", [this]( const ai::Search::State * const state_in ) { return zeroHeuristic( state_in ); }, 0.0 );
+        break;
+      case FACELET_HEURISTIC:
+        mHeuristicPipeline.addComponent( "facelet", [this]( const ai::Search::State * const state_in ) { return faceletHeuristic( state_in ); }, 54.0 );
+        break;
+      case EDGE_FACELET_HEURISTIC:
+        mHeuristicPipeline.addComponent( "edge_facelet", [this]( const ai::Search::State * const state_in ) { return edgeFaceletHeuristic( state_in ); }, 24.0 );
+        break;
+      case CORNER_FACELET_HEURISTIC:
+        mHeuristicPipeline.addComponent( "corner_facelet", [this]( const ai::Search::State * const state_in ) { return cornerFaceletHeuristic( state_in ); }, 24.0 );
+        break;
+      case FACELET_MAX_HEURISTIC:
+        mHeuristicPipeline.addComponent( "edge_facelet", [this]( const ai::Search::State * const state_in ) { return edgeFaceletHeuristic( state_in ); }, 24.0 );
+        mHeuristicPipeline.addComponent( "corner_facelet", [this]( const ai::Search::State * const state_in ) { return cornerFaceletHeuristic( state_in ); }, 24.0 );
+        break;
+      case COLOR_COUNT_HEURISTIC:
+        mHeuristicPipeline.addComponent( "color_count", [this]( const ai::Search::State * const state_in ) { return colorCountHeuristic( state_in ); }, 200.0 );
+        break;
+      }
+    }
+
     double Problem::zeroHeuristic(const ai::Search::State  * const /*state_in*/) const {
       return 0;
     }
 
+    static PositionSet make_position_set( const std::vector< int >& positions ) {
+      PositionSet set;
+      for( auto it = positions.begin( ); it != positions.end( ); it++ ) {
+        set.set( *it );
+      }
+      return set;
+    }
+
+    /* The goal index bound is the fewest mismatched facelets over the goals,
+     * or a little less when goals share a wildcard mask.
+     */
     double Problem::faceletHeuristic(const ai::Search::State  * const state_in) const {
+      static const PositionSet all_positions = PositionSet( ).set( );
       const State * const state = dynamic_cast< const State * const >( state_in );
-      const std::vector< Facelet >& cube = state->getCube( ).getFacelets( );
-
-      double best_count = 2 * cube.size( );
-        
-      for( auto it = mGoalCubes.begin( ); it != mGoalCubes.end( ); it++ ) {
-        const std::vector< Facelet >& goal = it->getFacelets( );
-        double count = 0.0;
-        unsigned int i;
-        for( i = 0; i < cube.size( ); i++ ) {
-          if( goal[ i ] != '*' && cube[ i ] != goal[ i ] ) {
-            count += 1.0;
-          }
-        }
-        if( count < best_count ) {
-          best_count = count;
-        }
-      }
-      return best_count / 20.0;
+      return mGoalIndex.mismatchLowerBound( state->getCube( ), all_positions ) / 20.0;
     }
     
     double Problem::edgeFaceletHeuristic(const ai::Search::State  * const state_in) const {
-      const std::vector<unsigned int> edge_indexes = { 1,3,5,7, 10,12,14,16, 19,21,23,25, 28,30,32,34, 37,39,41,43, 46,48,50,52 };
+      static const PositionSet edge_positions = make_position_set( { 1,3,5,7, 10,12,14,16, 19,21,23,25, 28,30,32,34, 37,39,41,43, 46,48,50,52 } );
       const State * const state = dynamic_cast< const State * const >( state_in );
-      const std::vector< Facelet >& cube = state->getCube( ).getFacelets( );
-      
-      double best_count = 2 * cube.size( );
-        
-      for( auto it = mGoalCubes.begin( ); it != mGoalCubes.end( ); it++ ) {
-        const std::vector< Facelet >& goal = it->getFacelets( );
-        double count = 0.0;
-        unsigned int i;
-        for( i = 0; i < edge_indexes.size( ); i++ ) {
-          if( goal[ edge_indexes[i] ] != '*' && cube[ edge_indexes[i] ] != goal[ edge_indexes[i] ] ) {
-            count += 1.0;
-          }
-        }
-        if( count < best_count ) {
-          best_count = count;
-        }
-      }
-      return best_count / 8.0;
+      return mGoalIndex.mismatchLowerBound( state->getCube( ), edge_positions ) / 8.0;
     }
 
     double Problem::cornerFaceletHeuristic(const ai::Search::State  * const state_in) const {
-      const std::vector<unsigned int> corner_indexes = { 0,2,6,8, 9,11,15,17, 18,20,24,26, 27,29,33,35, 36,38,42,44, 45,47,51,53 };
+      static const PositionSet corner_positions = make_position_set( { 0,2,6,8, 9,11,15,17, 18,20,24,26, 27,29,33,35, 36,38,42,44, 45,47,51,53 } );
       const State * const state = dynamic_cast< const State * const >( state_in );
-      const std::vector< Facelet >& cube = state->getCube( ).getFacelets( );
-      
-      double best_count = 2 * cube.size( );
-        
-      for( auto it = mGoalCubes.begin( ); it != mGoalCubes.end( ); it++ ) {
-        const std::vector< Facelet >& goal = it->getFacelets( );
-        double count = 0.0;
-        unsigned int i;
-        for( i = 0; i < corner_indexes.size( ); i++ ) {
-          if( goal[ corner_indexes[i] ] != '*' && cube[ corner_indexes[i] ] != goal[ corner_indexes[i] ] ) {
-            count += 1.0;
-          }
-        }
-        if( count < best_count ) {
-          best_count = count;
-        }
-      }
-      return best_count / 8.0;
-    }
-
-    double Problem::faceletMaxHeuristic(const ai::Search::State  * const state_in) const {
-      return std::max( edgeFaceletHeuristic( state_in ), cornerFaceletHeuristic( state_in ) );
+      return mGoalIndex.mismatchLowerBound( state->getCube( ), corner_positions ) / 8.0;
     }
 
     double Problem::colorCountHeuristic(const ai::Search::State  * const state_in) const {
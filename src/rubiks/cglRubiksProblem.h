@@ -4,6 +4,10 @@
 #include "ai_search.h"
 #include "cglRubiksAction.h"
 #include "cglRubiksState.h"
+#include "cglRubiksHeuristic.h"
+#include "cglRubiksGoalIndex.h"
+#include "cglRubiksRandom.h"
+#include <iostream>
 #include <map>
 #include <vector>
 #include <string>
@@ -15,9 +19,15 @@ namespace cgl {
     public:
       //                   0                  1               2                       3                         4
       enum HeuristicEnum { FACELET_HEURISTIC, ZERO_HEURISTIC, EDGE_FACELET_HEURISTIC, CORNER_FACELET_HEURISTIC, FACELET_MAX_HEURISTIC,
-                           COLOR_COUNT_HEURISTIC=10 };
+                           COLOR_COUNT_HEURISTIC=10,
+                           // plan heuristics, see PlanProblem
+                           PLAN_FACELET_HEURISTIC=11, PLAN_DISTANCE_HEURISTIC=12 };
 
       Problem( ai::Search::State *initial_state_in, const std::vector< Cube >& goal_cube_in );
+      // the pipeline's components call back into their Problem, so copies
+      // build their own, with fresh evaluation counts
+      Problem( const Problem& rhs );
+      Problem& operator=( const Problem& rhs );
       virtual ~Problem( );
 
       virtual bool GoalTest( const ai::Search::State * const state_in ) const;
@@ -29,6 +39,7 @@ namespace cgl {
                                const ai::Search::State  * const state2_in ) const;
 
       virtual double Heuristic(const ai::Search::State  * const state_in) const;
+      virtual double BoundedHeuristic(const ai::Search::State  * const state_in, double bound_in) const;
 
       const std::vector< Cube >& getGoalCubes( ) const;
 
@@ -43,22 +54,32 @@ namespace cgl {
       HeuristicEnum getHeuristic( ) const;
       void setHeuristic( const HeuristicEnum& heuristic );
       void setAllowedMoves( const std::map< std::string, Move >& allowed_moves );
+      // seeds the order Actions( ) returns moves in
+      void seedRandom( const std::uint64_t seed );
+
+      // per-component heuristic evaluation counts
+      const HeuristicPipeline& getHeuristicPipeline( ) const;
+      void displayHeuristicStats( std::ostream& os ) const;
       
     protected:
+      void buildHeuristicPipeline( );
+
       double zeroHeuristic(const ai::Search::State  * const state_in) const;
       double faceletHeuristic(const ai::Search::State  * const state_in) const;
       double edgeFaceletHeuristic(const ai::Search::State  * const state_in) const;
       double cornerFaceletHeuristic(const ai::Search::State  * const state_in) const;
-      double faceletMaxHeuristic(const ai::Search::State  * const state_in) const;
       double colorCountHeuristic(const ai::Search::State  * const state_in) const;
       
       std::vector< Cube > mGoalCubes;
+      GoalIndex mGoalIndex;
 
       bool mHalfTurns;
       bool mSliceTurns;
       std::map< std::string, Move > mAllowedMoves;
 
       HeuristicEnum mHeuristic;
+      HeuristicPipeline mHeuristicPipeline;
+      Random mRandom;
       
     private:
       
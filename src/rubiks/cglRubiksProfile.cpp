@@ -0,0 +1,365 @@
+#include "cglRubiksCommand.h"
+#include "cglRubiksAppData.h"
+#include "cglRubiksProblem.h"
+#include "cglRubiksState.h"
+#include "cglRubiksTokenizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*********************************************
+     * Heuristic profiling
+     */
+
+    /* the heuristics of Problem, plan heuristics need a PlanProblem */
+    static const std::vector< std::pair< std::string, Problem::HeuristicEnum > > PROFILED_HEURISTICS = {
+      { "zero", Problem::ZERO_HEURISTIC },
+      { "facelet", Problem::FACELET_HEURISTIC },
+      { "edge_facelet", Problem::EDGE_FACELET_HEURISTIC },
+      { "corner_facelet", Problem::CORNER_FACELET_HEURISTIC },
+      { "facelet_max", Problem::FACELET_MAX_HEURISTIC },
+      { "color_count", Problem::COLOR_COUNT_HEURISTIC },
+    };
+
+    /* heuristic values are compared with this slack, they are sums of fractions */
+    static const double PROFILE_EPSILON = 1e-9;
+
+    struct ProfileMove {
+      std::vector< int > transform;
+      int                cost;
+    };
+
+    /* Every cube within max_cost of a goal cube, with its exact cost to
+     * the nearest goal.  Cubes are numbered in order of cost.
+     */
+    struct DistanceTable {
+      std::unordered_map< std::string, std::uint32_t > index;
+      std::vector< const std::string * >              cubes;
+      std::vector< int >                              cost;
+    };
+
+    /* the predecessors of cubes[ begin, end ) that are not yet in the table,
+     * by the cost of the move, so successors[ c - 1 ] are c more than the cubes
+     */
+    static void profile_layer_aux( const DistanceTable& table, const size_t begin, const size_t end,
+                                   const std::vector< ProfileMove >& moves, const int max_cost,
+                                   std::vector< std::vector< std::string > >& successors ) {
+      std::string previous( NUM_POSITIONS_TOTAL, ' ' );
+      size_t i;
+      for( i = begin; i < end; i++ ) {
+        const std::string& current = *table.cubes[ i ];
+        for( auto m = moves.begin( ); m != moves.end( ); m++ ) {
+          if( table.cost[ i ] + m->cost > max_cost ) {
+            continue;
+          }
+          /* the cube that m turns into current */
+          unsigned int p;
+          for( p = 0; p < current.size( ); p++ ) {
+            previous[ p ] = current[ m->transform[ p ] ];
+          }
+          if( table.index.count( previous ) == 0 ) {
+            successors[ m->cost - 1 ].push_back( previous );
+          }
+        }
+      }
+    }
+
+    /* Dijkstra by cost layers, backwards from the goal cubes.  Each
+     * layer is expanded by num_threads threads, reading the table, then
+     * merged.
+     */
+    static void build_distance_table( const std::vector< Cube >& goal_cubes, const std::vector< ProfileMove >& moves,
+                                      const int max_cost, const unsigned int num_threads, DistanceTable& table ) {
+      int max_move_cost = 1;
+      for( auto m = moves.begin( ); m != moves.end( ); m++ ) {
+        max_move_cost = std::max( max_move_cost, m->cost );
+      }
+      std::vector< std::vector< std::string > > pending( max_cost + 1 );
+      for( auto it = goal_cubes.begin( ); it != goal_cubes.end( ); it++ ) {
+        pending[ 0 ].push_back( std::string( it->getFacelets( ).begin( ), it->getFacelets( ).end( ) ) );
+      }
+
+      int cost;
+      for( cost = 0; cost <= max_cost; cost++ ) {
+        /* the first to reach a cube comes from the cheapest layer */
+        const size_t layer_begin = table.cubes.size( );
+        for( auto it = pending[ cost ].begin( ); it != pending[ cost ].end( ); it++ ) {
+          auto inserted = table.index.insert( std::make_pair( *it, static_cast< std::uint32_t >( table.cubes.size( ) ) ) );
+          if( inserted.second ) {
+            table.cubes.push_back( &inserted.first->first );
+            table.cost.push_back( cost );
+          }
+        }
+        std::vector< std::string >( ).swap( pending[ cost ] );
+        const size_t layer_end = table.cubes.size( );
+        if( layer_begin == layer_end || cost == max_cost ) {
+          continue;
+        }
+
+        const size_t num_chunks = std::min( static_cast< size_t >( num_threads ), layer_end - layer_begin );
+        std::vector< std::vector< std::vector< std::string > > > successors( num_chunks, std::vector< std::vector< std::string > >( max_move_cost ) );
+        std::vector< std::thread > workers;
+        size_t i;
+        for( i = 0; i < num_chunks; i++ ) {
+          const size_t begin = layer_begin + ( layer_end - layer_begin ) * i / num_chunks;
+          const size_t end = layer_begin + ( layer_end - layer_begin ) * ( i + 1 ) / num_chunks;
+          workers.push_back( std::thread( profile_layer_aux, std::cref( table ), begin, end, std::cref( moves ), max_cost,
+                                          std::ref( successors[ i ] ) ) );
+        }
+        for( auto it = workers.begin( ); it != workers.end( ); it++ ) {
+          it->join( );
+        }
+        for( auto chunk = successors.begin( ); chunk != successors.end( ); chunk++ ) {
+          int c;
+          for( c = 1; c <= max_move_cost; c++ ) {
+            std::vector< std::string >& layer = ( *chunk )[ c - 1 ];
+            if( !layer.empty( ) ) {
+              pending[ cost + c ].insert( pending[ cost + c ].end( ), layer.begin( ), layer.end( ) );
+            }
+          }
+        }
+      }
+    }
+
+    struct HeuristicProfile {
+      HeuristicProfile( )
+        : ratio_sum( 0.0 ), ratio_count( 0 ), overestimates( 0 ), max_overestimate( 0.0 ),
+          edges( 0 ), inconsistencies( 0 ), max_inconsistency( 0.0 ) {
+      }
+      void add( const HeuristicProfile& rhs ) {
+        ratio_sum += rhs.ratio_sum;
+        ratio_count += rhs.ratio_count;
+        overestimates += rhs.overestimates;
+        max_overestimate = std::max( max_overestimate, rhs.max_overestimate );
+        edges += rhs.edges;
+        inconsistencies += rhs.inconsistencies;
+        max_inconsistency = std::max( max_inconsistency, rhs.max_inconsistency );
+        for( auto it = rhs.histogram.begin( ); it != rhs.histogram.end( ); it++ ) {
+          histogram[ it->first ] += it->second;
+        }
+      }
+      double                            ratio_sum;        // h / d, over cubes with d > 0
+      std::uint64_t                     ratio_count;
+      std::uint64_t                     overestimates;    // h > d
+      double                            max_overestimate;
+      std::uint64_t                     edges;            // moves between cubes in the table
+      std::uint64_t                     inconsistencies;  // h( a ) > cost + h( b )
+      double                            max_inconsistency;
+      std::map< double, std::uint64_t > histogram;        // cubes by h
+    };
+
+    /* evaluate every heuristic on cubes[ begin, end ), one Problem per heuristic for this thread */
+    static void profile_evaluate_aux( const DistanceTable& table, const std::vector< Cube >& goal_cubes,
+                                      const size_t begin, const size_t end,
+                                      std::vector< double >& h, std::vector< HeuristicProfile >& profiles ) {
+      const size_t num_heuristics = PROFILED_HEURISTICS.size( );
+      State state( goal_cubes[ 0 ] );
+      std::vector< Problem * > problems;
+      size_t k;
+      for( k = 0; k < num_heuristics; k++ ) {
+        problems.push_back( new Problem( &state, goal_cubes ) );
+        problems.back( )->setHeuristic( PROFILED_HEURISTICS[ k ].second );
+      }
+      size_t i;
+      for( i = begin; i < end; i++ ) {
+        state.getCube( ).assignFromString( *table.cubes[ i ] );
+        const double d = table.cost[ i ];
+        for( k = 0; k < num_heuristics; k++ ) {
+          const double value = problems[ k ]->Heuristic( &state );
+          HeuristicProfile& profile = profiles[ k ];
+          h[ i * num_heuristics + k ] = value;
+          profile.histogram[ value ]++;
+          if( d > 0 ) {
+            profile.ratio_sum += value / d;
+            profile.ratio_count++;
+          }
+          if( value > d + PROFILE_EPSILON ) {
+            profile.overestimates++;
+            profile.max_overestimate = std::max( profile.max_overestimate, value - d );
+          }
+        }
+      }
+      for( auto it = problems.begin( ); it != problems.end( ); it++ ) {
+        delete *it;
+      }
+    }
+
+    /* check h( a ) <= cost + h( b ) for every move from a in cubes[ begin, end ) to b in the table */
+    static void profile_consistency_aux( const DistanceTable& table, const std::vector< ProfileMove >& moves,
+                                         const size_t begin, const size_t end,
+                                         const std::vector< double >& h, std::vector< HeuristicProfile >& profiles ) {
+      const size_t num_heuristics = PROFILED_HEURISTICS.size( );
+      std::string next( NUM_POSITIONS_TOTAL, ' ' );
+      size_t i;
+      for( i = begin; i < end; i++ ) {
+        const std::string& current = *table.cubes[ i ];
+        for( auto m = moves.begin( ); m != moves.end( ); m++ ) {
+          unsigned int p;
+          for( p = 0; p < current.size( ); p++ ) {
+            next[ m->transform[ p ] ] = current[ p ];
+          }
+          auto found = table.index.find( next );
+          if( found == table.index.end( ) ) {
+            continue;
+          }
+          const size_t j = found->second;
+          size_t k;
+          for( k = 0; k < num_heuristics; k++ ) {
+            HeuristicProfile& profile = profiles[ k ];
+            const double excess = h[ i * num_heuristics + k ] - m->cost - h[ j * num_heuristics + k ];
+            profile.edges++;
+            if( excess > PROFILE_EPSILON ) {
+              profile.inconsistencies++;
+              profile.max_inconsistency = std::max( profile.max_inconsistency, excess );
+            }
+          }
+        }
+      }
+    }
+
+    /* Korf, Reid and Edelkamp: an IDA* iteration with cost threshold c
+     * expands sum over g of N( g ) P( c - g ) nodes, where N( g ) counts
+     * the paths of cost g and P( v ) is the fraction of cubes with h <= v.
+     * P is taken over the cubes in the table.
+     */
+    static double predict_ida_nodes( const HeuristicProfile& profile, const std::vector< ProfileMove >& moves, const int threshold ) {
+      std::vector< double > paths( threshold + 1, 0.0 );
+      paths[ 0 ] = 1.0;
+      int g;
+      for( g = 1; g <= threshold; g++ ) {
+        for( auto m = moves.begin( ); m != moves.end( ); m++ ) {
+          if( m->cost <= g ) {
+            paths[ g ] += paths[ g - m->cost ];
+          }
+        }
+      }
+      std::uint64_t total = 0;
+      for( auto it = profile.histogram.begin( ); it != profile.histogram.end( ); it++ ) {
+        total += it->second;
+      }
+      double nodes = 0.0;
+      for( g = 0; g <= threshold; g++ ) {
+        std::uint64_t at_most = 0;
+        for( auto it = profile.histogram.begin( ); it != profile.histogram.end( ) && it->first <= threshold - g + PROFILE_EPSILON; it++ ) {
+          at_most += it->second;
+        }
+        nodes += paths[ g ] * at_most / total;
+      }
+      return nodes;
+    }
+
+    int profile_heuristic( AppData& data ) {
+      if( data.words.size( ) != 2 ) {
+        return EXIT_USAGE;
+      }
+      int max_cost = -1;
+      if( !parse_number( data.words[ 1 ], max_cost ) || max_cost < 0 ) {
+        return EXIT_USAGE;
+      }
+      for( auto it = data.goal_cubes.begin( ); it != data.goal_cubes.end( ); it++ ) {
+        const std::vector< Facelet >& facelets = it->getFacelets( );
+        if( std::find( facelets.begin( ), facelets.end( ), '*' ) != facelets.end( ) ) {
+          data.os << "profile_heuristic needs goal cubes without wildcards." << std::endl;
+          return EXIT_USAGE_HELP;
+        }
+      }
+      if( data.goal_cubes.empty( ) ) {
+        data.os << "profile_heuristic needs a goal cube." << std::endl;
+        return EXIT_USAGE_HELP;
+      }
+
+      /* zero cost moves, e.g. whole cube rotations, would not leave their layer */
+      std::vector< ProfileMove > moves;
+      for( auto it = data.move_set->getMoves( ).begin( ); it != data.move_set->getMoves( ).end( ); it++ ) {
+        const int cost = static_cast< int >( std::lround( it->second.getCost( ) ) );
+        if( cost > 0 ) {
+          moves.push_back( { it->second.getTransform( ), cost } );
+        }
+      }
+      unsigned int num_threads = data.config.workerThreads( );
+
+      DistanceTable table;
+      build_distance_table( data.goal_cubes, moves, max_cost, num_threads, table );
+
+      const size_t num_heuristics = PROFILED_HEURISTICS.size( );
+      const size_t num_cubes = table.cubes.size( );
+      const size_t num_chunks = std::min( static_cast< size_t >( num_threads ), num_cubes );
+      std::vector< double > h( num_cubes * num_heuristics );
+      std::vector< std::vector< HeuristicProfile > > chunk_profiles( num_chunks, std::vector< HeuristicProfile >( num_heuristics ) );
+      std::vector< std::thread > workers;
+      size_t i;
+      for( i = 0; i < num_chunks; i++ ) {
+        workers.push_back( std::thread( profile_evaluate_aux, std::cref( table ), std::cref( data.goal_cubes ),
+                                        num_cubes * i / num_chunks, num_cubes * ( i + 1 ) / num_chunks,
+                                        std::ref( h ), std::ref( chunk_profiles[ i ] ) ) );
+      }
+      for( auto it = workers.begin( ); it != workers.end( ); it++ ) {
+        it->join( );
+      }
+      workers.clear( );
+      for( i = 0; i < num_chunks; i++ ) {
+        workers.push_back( std::thread( profile_consistency_aux, std::cref( table ), std::cref( moves ),
+                                        num_cubes * i / num_chunks, num_cubes * ( i + 1 ) / num_chunks,
+                                        std::cref( h ), std::ref( chunk_profiles[ i ] ) ) );
+      }
+      for( auto it = workers.begin( ); it != workers.end( ); it++ ) {
+        it->join( );
+      }
+      std::vector< HeuristicProfile > profiles( num_heuristics );
+      for( auto chunk = chunk_profiles.begin( ); chunk != chunk_profiles.end( ); chunk++ ) {
+        size_t k;
+        for( k = 0; k < num_heuristics; k++ ) {
+          profiles[ k ].add( ( *chunk )[ k ] );
+        }
+      }
+
+      std::vector< std::uint64_t > per_cost( max_cost + 1, 0 );
+      for( auto it = table.cost.begin( ); it != table.cost.end( ); it++ ) {
+        per_cost[ *it ]++;
+      }
+      data.os << "Profiled " << num_cubes << " cubes within cost " << max_cost << " of the goal:";
+      int cost;
+      for( cost = 0; cost <= max_cost; cost++ ) {
+        data.os << " " << cost << ":" << per_cost[ cost ];
+      }
+      data.os << std::endl;
+      data.os << std::left << std::setw( 16 ) << "heuristic" << std::right
+              << std::setw( 10 ) << "mean h/d"
+              << std::setw( 14 ) << "inadmissible"
+              << std::setw( 10 ) << "max over"
+              << std::setw( 14 ) << "inconsistent"
+              << std::setw( 10 ) << "max over"
+              << std::setw( 16 ) << "IDA* nodes" << std::endl;
+      size_t k;
+      for( k = 0; k < num_heuristics; k++ ) {
+        const HeuristicProfile& profile = profiles[ k ];
+        data.os << std::left << std::setw( 16 ) << PROFILED_HEURISTICS[ k ].first << std::right
+                << std::fixed << std::setprecision( 3 )
+                << std::setw( 10 ) << ( profile.ratio_count > 0 ? profile.ratio_sum / profile.ratio_count : 0.0 )
+                << std::setw( 14 ) << profile.overestimates
+                << std::setw( 10 ) << profile.max_overestimate
+                << std::setw( 14 ) << profile.inconsistencies
+                << std::setw( 10 ) << profile.max_inconsistency
+                << std::setw( 16 ) << std::setprecision( 0 ) << predict_ida_nodes( profile, moves, max_cost ) << std::endl;
+        data.os.unsetf( std::ios::floatfield );
+        data.os << std::setprecision( 6 );
+      }
+      return EXIT_OK;
+    }
+
+    /*
+     * Heuristic profiling
+     *********************************************/
+
+  }
+}
@@ -0,0 +1,68 @@
+#include "cglRubiksRandom.h"
+#include <chrono>
+
+namespace cgl {
+  namespace rubiks {
+
+    static std::uint64_t splitmix64( std::uint64_t& x ) {
+      std::uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+      z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+      z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+      return z ^ ( z >> 31 );
+    }
+
+    static inline std::uint64_t rotl( const std::uint64_t x, const int k ) {
+      return ( x << k ) | ( x >> ( 64 - k ) );
+    }
+
+    Random::Random( const std::uint64_t seed ) {
+      this->seed( seed );
+    }
+
+    void Random::seed( const std::uint64_t seed ) {
+      mSeed = seed;
+      std::uint64_t x = seed;
+      int i;
+      for( i = 0; i < 4; i++ ) {
+        mState[ i ] = splitmix64( x );
+      }
+    }
+
+    std::uint64_t Random::clockSeed( ) {
+      return std::chrono::high_resolution_clock::now( ).time_since_epoch( ).count( );
+    }
+
+    Random Random::stream( const std::uint64_t index ) const {
+      /* mix the index in, so nearby indexes give unrelated seeds */
+      std::uint64_t x = mSeed ^ ( index * 0xd1b54a32d192ed03ULL );
+      return Random( splitmix64( x ) );
+    }
+
+    std::uint64_t Random::next( ) {
+      const std::uint64_t result = rotl( mState[ 1 ] * 5, 7 ) * 9;
+      const std::uint64_t t = mState[ 1 ] << 17;
+      mState[ 2 ] ^= mState[ 0 ];
+      mState[ 3 ] ^= mState[ 1 ];
+      mState[ 1 ] ^= mState[ 2 ];
+      mState[ 0 ] ^= mState[ 3 ];
+      mState[ 2 ] ^= t;
+      mState[ 3 ] = rotl( mState[ 3 ], 45 );
+      return result;
+    }
+
+    Random::result_type Random::operator( )( ) {
+      return next( );
+    }
+
+    std::uint64_t Random::below( const std::uint64_t n ) {
+      /* reject the top partial copy of [ 0, n ) */
+      const std::uint64_t limit = max( ) - max( ) % n;
+      std::uint64_t x;
+      do {
+        x = next( );
+      } while( x >= limit );
+      return x % n;
+    }
+
+  }
+}
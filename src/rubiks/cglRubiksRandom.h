@@ -0,0 +1,56 @@
+#ifndef _CGLRUBIKSRANDOM_H_
+#define _CGLRUBIKSRANDOM_H_
+
+#include <cstdint>
+#include <limits>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*
+     * A xoshiro256** generator.  It is small and cheap to copy, so each
+     * thread or search keeps its own instead of sharing one.
+     *
+     * Streams for threads, searches and batch items are derived from a
+     * parent's seed and an index by stream( ), so a run with a fixed
+     * `config seed` draws the same numbers whatever the thread timing.
+     *
+     * Satisfies UniformRandomBitGenerator, for std::shuffle and the
+     * std distributions.
+     */
+    class Random {
+    public:
+      typedef std::uint64_t result_type;
+
+      /* seeded by splitmix64 from seed, any value is fine */
+      Random( const std::uint64_t seed = 0 );
+      void seed( const std::uint64_t seed );
+      /* a seed from the clock, for `config seed 0` */
+      static std::uint64_t clockSeed( );
+
+      /* an independent generator for the index'th thread, search or item */
+      Random stream( const std::uint64_t index ) const;
+
+      std::uint64_t next( );
+      result_type operator( )( );
+      /* uniform in [ 0, n ), n > 0, without modulo bias */
+      std::uint64_t below( const std::uint64_t n );
+
+      static constexpr result_type min( ) { return 0; }
+      static constexpr result_type max( ) { return std::numeric_limits< result_type >::max( ); }
+
+    protected:
+      std::uint64_t mSeed;
+      std::uint64_t mState[ 4 ];
+
+    private:
+    };
+
+  }
+}
+
+
+#endif /* _CGLRUBIKSRANDOM_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
@@ -0,0 +1,111 @@
+#include "cglRubiksRandomCube.h"
+#include <utility>
+
+namespace cgl {
+  namespace rubiks {
+
+    /* The facelets of each corner and edge position, in the order
+     * U R F, U F L, ... so a twist or flip rotates through the list the
+     * same way at every position.  A cubie's home position is its
+     * index here.
+     */
+    static const int NUM_CORNERS = 8;
+    static const int NUM_EDGES = 12;
+    static const int CORNER_FACELETS[ NUM_CORNERS ][ 3 ] = {
+      {  8, 27, 20 }, // URF
+      {  6, 18, 11 }, // UFL
+      {  0,  9, 38 }, // ULB
+      {  2, 36, 29 }, // UBR
+      { 47, 26, 33 }, // DFR
+      { 45, 17, 24 }, // DLF
+      { 51, 44, 15 }, // DBL
+      { 53, 35, 42 }  // DRB
+    };
+    static const int EDGE_FACELETS[ NUM_EDGES ][ 2 ] = {
+      {  5, 28 }, // UR
+      {  7, 19 }, // UF
+      {  3, 10 }, // UL
+      {  1, 37 }, // UB
+      { 50, 34 }, // DR
+      { 46, 25 }, // DF
+      { 48, 16 }, // DL
+      { 52, 43 }, // DB
+      { 23, 30 }, // FR
+      { 21, 14 }, // FL
+      { 41, 12 }, // BL
+      { 39, 32 }  // BR
+    };
+
+    RandomCubeSampler::RandomCubeSampler( const std::uint64_t seed )
+      : mRandom( seed ), mTransform( NUM_POSITIONS_TOTAL ) {
+      // empty
+    }
+
+    void RandomCubeSampler::sampleTransform( std::vector< int >& transform ) {
+      int cp[ NUM_CORNERS ], co[ NUM_CORNERS ], ep[ NUM_EDGES ], eo[ NUM_EDGES ];
+      int corner_parity = samplePermutation( cp, NUM_CORNERS );
+      int edge_parity = samplePermutation( ep, NUM_EDGES );
+      if( corner_parity != edge_parity ) {
+        /* pairs odd edge permutations with even ones one to one */
+        std::swap( ep[ NUM_EDGES - 2 ], ep[ NUM_EDGES - 1 ] );
+      }
+      sampleOrientation( co, NUM_CORNERS, 3 );
+      sampleOrientation( eo, NUM_EDGES, 2 );
+
+      transform.resize( NUM_POSITIONS_TOTAL );
+      int i, k;
+      for( i = 0; i < NUM_POSITIONS_TOTAL; i++ ) {
+        transform[ i ] = i;
+      }
+      /* cubie cp[ i ] moves to position i, twisted by co[ i ] */
+      for( i = 0; i < NUM_CORNERS; i++ ) {
+        for( k = 0; k < 3; k++ ) {
+          transform[ CORNER_FACELETS[ cp[ i ] ][ k ] ] = CORNER_FACELETS[ i ][ ( k + co[ i ] ) % 3 ];
+        }
+      }
+      for( i = 0; i < NUM_EDGES; i++ ) {
+        for( k = 0; k < 2; k++ ) {
+          transform[ EDGE_FACELETS[ ep[ i ] ][ k ] ] = EDGE_FACELETS[ i ][ ( k + eo[ i ] ) % 2 ];
+        }
+      }
+    }
+
+    void RandomCubeSampler::sample( const Cube& cube, std::string& facelets ) {
+      sampleTransform( mTransform );
+      const std::vector< Facelet >& from = cube.getFacelets( );
+      facelets.resize( from.size( ) );
+      unsigned int i;
+      for( i = 0; i < from.size( ); i++ ) {
+        facelets[ mTransform[ i ] ] = from[ i ];
+      }
+    }
+
+    int RandomCubeSampler::samplePermutation( int *p, const int n ) {
+      int parity = 0;
+      int i;
+      for( i = 0; i < n; i++ ) {
+        p[ i ] = i;
+      }
+      /* Fisher-Yates, each swap of two different entries flips the parity */
+      for( i = n - 1; i > 0; i-- ) {
+        int j = mRandom.below( i + 1 );
+        if( j != i ) {
+          std::swap( p[ i ], p[ j ] );
+          parity ^= 1;
+        }
+      }
+      return parity;
+    }
+
+    void RandomCubeSampler::sampleOrientation( int *o, const int n, const int k ) {
+      int sum = 0;
+      int i;
+      for( i = 0; i < n - 1; i++ ) {
+        o[ i ] = mRandom.below( k );
+        sum += o[ i ];
+      }
+      o[ n - 1 ] = ( k - sum % k ) % k;
+    }
+
+  }
+}
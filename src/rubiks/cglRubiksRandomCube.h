@@ -0,0 +1,53 @@
+#ifndef _CGLRUBIKSRANDOMCUBE_H_
+#define _CGLRUBIKSRANDOMCUBE_H_
+
+#include "cglRubiksCube.h"
+#include "cglRubiksRandom.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*
+     * Draws elements of the cube group uniformly at random, by choosing
+     * the corner and edge cubies' positions and orientations directly
+     * instead of applying random moves.
+     *
+     * Corner and edge permutations have equal parity, corner twists sum
+     * to 0 mod 3, and edge flips sum to 0 mod 2, so every one of the
+     * 8! 3^7 12! 2^11 / 2 reachable arrangements is equally likely.
+     * Centers do not move.
+     */
+    class RandomCubeSampler {
+    public:
+      RandomCubeSampler( const std::uint64_t seed );
+
+      /* a random transform, in the same form as Move::getTransform:
+       * the facelet at i moves to transform[ i ]
+       */
+      void sampleTransform( std::vector< int >& transform );
+      /* the facelets of cube after a random transform */
+      void sample( const Cube& cube, std::string& facelets );
+
+    protected:
+      /* a random permutation of 0 .. n-1 in p, returns its parity */
+      int samplePermutation( int *p, const int n );
+      /* n random orientations in o, in 0 .. k-1, that sum to 0 mod k */
+      void sampleOrientation( int *o, const int n, const int k );
+
+      Random             mRandom;
+      std::vector< int > mTransform;
+
+    private:
+    };
+
+  }
+}
+
+
+#endif /* _CGLRUBIKSRANDOMCUBE_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
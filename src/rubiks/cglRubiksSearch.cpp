@@ -1,4 +1,5 @@
 #include "cglRubiksCommand.h"
+#include "cglRubiksSearch.h"
 #include "cglRubiksAppData.h"
 #include "cglRubiksState.h"
 #include "cglRubiksAction.h"
@@ -6,6 +7,19 @@
 #include "cglRubiksPlanProblem.h"
 #include "ai_search.h"
 #include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 
 namespace cgl {
   namespace rubiks {
@@ -58,6 +72,15 @@ namespace cgl {
       }
       (*algorithm)->SetGenerationLimit( data.config.generationLimit( ) );
       (*algorithm)->SetStoreLimit( data.config.storageLimit( ) );
+      (*algorithm)->SetMemoryLimit( static_cast< size_t >( data.config.memoryLimit( ) * 1024 * 1024 ) );
+      if( data.config.progressInterval( ) > 0 ) {
+        (*algorithm)->SetProgress( &std::cerr, data.config.progressInterval( ) );
+      }
+      if( data.trace ) {
+        (*algorithm)->SetTrace( data.trace.get( ), data.config.traceSampleInterval( ) );
+      }
+      (*algorithm)->SetPerfCounters( data.config.perfCounters( ) );
+      (*algorithm)->SetAllocationProfile( data.config.allocProfile( ) );
 
       return EXIT_OK;
     }
@@ -66,7 +89,9 @@ namespace cgl {
       // initial state
       cgl::rubiks::State *initial_state = new cgl::rubiks::State( data.cube );
       // problem
-      cgl::rubiks::PlanProblem *problem = new cgl::rubiks::PlanProblem( initial_state, data.plan_action_set, data.goal_cubes );
+      cgl::rubiks::PlanProblem *problem = new cgl::rubiks::PlanProblem( initial_state, *data.plan_action_set, data.goal_cubes );
+      problem->setHeuristic( static_cast< Problem::HeuristicEnum >( data.config.heuristic( ) ) );
+      problem->seedRandom( data.random.next( ) );
       
       int ok;
 
@@ -94,8 +119,9 @@ namespace cgl {
       cgl::rubiks::State *initial_state = new cgl::rubiks::State( data.cube );
       // problem
       cgl::rubiks::Problem *problem = new cgl::rubiks::Problem( initial_state, data.goal_cubes );
-      problem->setAllowedMoves( data.move_set.getMoves( ) );
+      problem->setAllowedMoves( data.move_set->getMoves( ) );
       problem->setHeuristic( static_cast< Problem::HeuristicEnum >( data.config.heuristic( ) ) );
+      problem->seedRandom( data.random.next( ) );
       
       int ok;
 
@@ -118,37 +144,61 @@ namespace cgl {
       return EXIT_OK;
     }
 
-    static int search_aux( AppData& data ) {
+    static void show_heuristic_stats( AppData& data, const ai::Search::Algorithm *algorithm ) {
+      const cgl::rubiks::Problem *problem = dynamic_cast< const cgl::rubiks::Problem * >( algorithm->GetProblem( ) );
+      if( problem ) {
+        problem->displayHeuristicStats( data.os );
+      }
+      const cgl::rubiks::PlanProblem *plan_problem = dynamic_cast< const cgl::rubiks::PlanProblem * >( algorithm->GetProblem( ) );
+      if( plan_problem ) {
+        plan_problem->displayHeuristicStats( data.os );
+      }
+    }
+
+    /* With the alloc_profile configuration, the heap allocations the search made. */
+    static void show_allocation_stats( AppData& data, const ai::Search::Algorithm *algorithm ) {
+      const ai::Search::Statistics& statistics = algorithm->GetStatistics( );
+      if( !statistics.GetAllocationsCounted( ) ) {
+        return;
+      }
+      const std::uint64_t allocations = ai::Search::AllocationProfile::TotalAllocations( statistics.GetAllocations( ) );
+      const std::uint64_t frees = ai::Search::AllocationProfile::TotalFrees( statistics.GetAllocations( ) );
+      const std::uint64_t expansions = statistics.GetCounter( ai::Search::Statistics::C_EXPANSIONS );
+      data.os << "Allocated " << allocations << " times, "
+              << static_cast< double >( allocations ) / std::max< std::uint64_t >( expansions, 1 ) << " per expanded node, "
+              << static_cast< std::int64_t >( allocations - frees ) << " still live." << std::endl;
+    }
+
+    int search_core( AppData& data, SearchResult& result ) {
       int max_iterations = 1;
       if( data.words.size( ) > 2 && data.words[ 2 ] == "ids" ) {
         max_iterations = data.config.idsLimit( );
       }
 
       int i;
-      bool solved = false;
-      std::stringstream machine_stream;
-      unsigned int generated_nodes = 0;
-      size_t stored_nodes = 0;
-      double cost = 0.0;
-      std::stringstream rotations;
+      result.solved = false;
+      result.generated_nodes = 0;
+      result.stored_nodes = 0;
+      result.cost = 0.0;
+      result.rotations = "";
+      result.moves.clear( );
+      result.statistics.Clear( );
 
-      if( data.config.displaySolutionMachine( ) ) {
-        machine_stream << data.words[ 0 ] << " " << data.words[ 1 ] << " " << data.words[ 2 ] << " ";
-      }
-
-      for( i = 1; i <= max_iterations && !solved; i++ ) {
+      for( i = 1; i <= max_iterations && !result.solved; i++ ) {
         data.config.setIDSDepth( i );
 
-        ai::Search::Algorithm *algorithm = 0;
+        ai::Search::Algorithm *created = 0;
         int ok = EXIT_THROW;
         if( data.words[ 0 ] == "search" ) {
-          ok = search_init( data, &algorithm );
+          ok = search_init( data, &created );
         } else if( data.words[ 0 ] == "plan" ) {
-          ok = plan_init( data, &algorithm );
+          ok = plan_init( data, &created );
         } else {
           data.os << "Only search or plan understood." << std::endl;
           ok = EXIT_THROW;
         }
+        // owns the problem, frontier and nodes, also if Search throws
+        std::unique_ptr< ai::Search::Algorithm > algorithm( created );
         if( ok != EXIT_OK ) {
           return ok;
         }
@@ -159,9 +209,10 @@ namespace cgl {
       
         // Execute the search
         if( algorithm->Search( ) ) {
+          std::stringstream rotations;
           bool first = true;
-          cost = 0.0;
-          solved = true;
+          result.cost = 0.0;
+          result.solved = true;
           if( data.config.displaySolutionHuman( ) ) {
             data.os << "Found solution." << std::endl;
           }
@@ -178,62 +229,379 @@ namespace cgl {
                 first = false;
               }
               rotations << *action;
-              
-              if( data.config.applySolution( ) ) {
-                data.cube = action->getMove( ) * data.cube;
-              }
-              cost += action->getMove( ).getCost( );
+              result.moves.push_back( action->getMove( ) );
+              result.cost += action->getMove( ).getCost( );
             }
-            /*
-            if( (*it)->GetState( ) ) {
-              cgl::rubiks::State *state = dynamic_cast< cgl::rubiks::State * >( (*it)->GetState( ) );
-              data.os << "cube: " << *state << std::endl;
-            }
-            */
           }
+          result.rotations = rotations.str( );
           if( data.config.displaySolutionHuman( ) ) {
-            data.os << "rotate " << rotations.str( ) << std::endl;
-            data.os << "Cost: " << cost << std::endl;
+            data.os << "rotate " << result.rotations << std::endl;
+            data.os << "Cost: " << result.cost << std::endl;
             data.os << "Generated " << algorithm->GetNumberNodesGenerated() << " nodes." << std::endl;
             data.os << "Maximum frontier size " << algorithm->GetMaxNodesStored() << " nodes." << std::endl;
+            show_heuristic_stats( data, algorithm.get( ) );
+            show_allocation_stats( data, algorithm.get( ) );
             data.os << std::endl;
           }
-          if( data.config.displaySolutionMachine( ) ) {
-            generated_nodes += algorithm->GetNumberNodesGenerated( );
-            stored_nodes = std::max( stored_nodes, algorithm->GetMaxNodesStored( ) );
-          }
         } else {
           if( data.config.displaySolutionHuman( ) ) {
             data.os << "Could not find solution." << std::endl;
             data.os << "Generated " << algorithm->GetNumberNodesGenerated() << " nodes." << std::endl;
             data.os << "Maximum frontier size " << algorithm->GetMaxNodesStored() << " nodes." << std::endl;
+            show_heuristic_stats( data, algorithm.get( ) );
+            show_allocation_stats( data, algorithm.get( ) );
+            data.os << std::endl;
+          }
+        }
+        result.generated_nodes += algorithm->GetNumberNodesGenerated( );
+        result.stored_nodes = std::max( result.stored_nodes, algorithm->GetMaxNodesStored( ) );
+        result.statistics.Add( algorithm->GetStatistics( ) );
+      }
+      return EXIT_OK;
+    }
+
+    /* With the machine_stats configuration, the statistics follow the
+     * result as name value pairs.
+     */
+    static void write_machine_result( std::ostream& os, const AppConfig& config, const std::string& command, const SearchResult& result ) {
+      os << command << " ";
+      if( !result.solved ) {
+        os << "F " << result.generated_nodes << " " << result.stored_nodes;
+      } else {
+        os << "T " << result.generated_nodes << " " << result.stored_nodes << " ";
+        os << result.cost << " ";
+        os << "rotate " << result.rotations;
+      }
+      if( config.machineStats( ) ) {
+        os << " stats ";
+        result.statistics.DisplayFields( os );
+      }
+    }
+
+    static void show_machine_result( AppData& data, const std::string& command, const SearchResult& result ) {
+      std::stringstream machine_stream;
+      write_machine_result( machine_stream, data.config, command, result );
+      data.os << machine_stream.str( ) << std::endl;
+    }
+
+    /* Keeps the statistics for show stats. */
+    static void remember_statistics( AppData& data, const std::string& command, const SearchResult& result ) {
+      data.search_statistics = result.statistics;
+      data.search_statistics_command = command;
+    }
+
+    static void apply_moves( Cube& cube, const std::vector< Move >& moves ) {
+      for( auto it = moves.begin( ); it != moves.end( ); it++ ) {
+        cube = *it * cube;
+      }
+    }
+
+    /* The moves a search or plan may use, by name. */
+    static std::map< std::string, Move > search_vocabulary( AppData& data ) {
+      if( data.words[ 0 ] == "plan" ) {
+        std::map< std::string, Move > moves;
+        const std::map< std::string, PlanAction >& actions = data.plan_action_set->getDefinedActions( );
+        for( auto it = actions.begin( ); it != actions.end( ); it++ ) {
+          moves[ it->first ] = it->second.getEffect( );
+        }
+        return moves;
+      }
+      return data.move_set->getMoves( );
+    }
+
+    /* Hash of the compiled preconditions of the plan actions, which the
+     * effects alone do not describe.  Empty for searches.
+     */
+    static std::string search_conditions_hash( AppData& data ) {
+      if( data.words[ 0 ] != "plan" ) {
+        return "";
+      }
+      std::stringstream ss;
+      const std::map< std::string, PlanAction >& actions = data.plan_action_set->getDefinedActions( );
+      for( auto it = actions.begin( ); it != actions.end( ); it++ ) {
+        ss << it->first << ":";
+        const std::vector< FaceletPattern >& patterns = it->second.getCompiledPreconditions( );
+        for( auto p = patterns.begin( ); p != patterns.end( ); p++ ) {
+          int w;
+          for( w = 0; w < NUM_PACKED_WORDS; w++ ) {
+            ss << p->getMaskWord( w ) << "/" << p->getValueWord( w ) << ",";
+          }
+          ss << ";";
+        }
+      }
+      return " " + CubeSymmetry::hashText( ss.str( ) );
+    }
+
+    /* The settings that decide which solution a search finds. */
+    static std::string search_settings_key( const AppConfig& config ) {
+      std::stringstream ss;
+      ss << std::setprecision( 17 ) << " h" << config.heuristic( ) << " d" << config.depthLimit( )
+         << " a" << config.aStarLimit( ) << " i" << config.idsLimit( )
+         << " g" << config.generationLimit( ) << " s" << config.storageLimit( )
+         << " m" << config.memoryLimit( );
+      return ss.str( );
+    }
+
+    /* Looks up the canonical form of the problem in the solution cache.
+     * On a hit, the remembered moves are translated to this problem's
+     * orientation and checked before they are used.  Otherwise searches,
+     * and remembers a solution in the canonical orientation.
+     */
+    static int cached_search( AppData& data, SearchResult& result ) {
+      if( data.words.size( ) < 3 ) {
+        return EXIT_USAGE;
+      }
+      /* plan actions may test colors, so plans are only cached exactly */
+      const bool is_plan = data.words[ 0 ] == "plan";
+      const std::map< std::string, Move > moves = search_vocabulary( data );
+      CubeSymmetry symmetry( moves, !is_plan );
+      unsigned int rotation = 0;
+      std::string key = data.words[ 0 ] + " " + data.words[ 1 ] + " " + data.words[ 2 ] + search_settings_key( data.config ) + " " + symmetry.getMovesHash( ) + search_conditions_hash( data ) + " " + symmetry.canonicalize( data.goal_cubes, data.cube, rotation );
+
+      SolutionCache& cache = *data.solution_cache;
+      if( data.owns_solution_cache ) {
+        cache.setCapacity( data.config.cacheCapacity( ) );
+      }
+      SolutionCache::Entry entry;
+      if( cache.lookup( key, entry ) ) {
+        result.solved = true;
+        result.generated_nodes = 0;
+        result.stored_nodes = 0;
+        result.cost = 0.0;
+        result.moves.clear( );
+        result.statistics.Clear( );
+        std::stringstream rotations;
+        Cube cube = data.cube;
+        bool valid = true;
+        for( auto it = entry.moves.begin( ); it != entry.moves.end( ) && valid; it++ ) {
+          try {
+            const std::string& name = symmetry.fromCanonical( rotation, *it );
+            const Move& move = moves.at( name );
+            if( is_plan && !data.plan_action_set->getDefinedAction( name ).conditionsAreMet( cube ) ) {
+              valid = false;
+              break;
+            }
+            if( it != entry.moves.begin( ) ) {
+              rotations << " ";
+            }
+            rotations << move.getName( );
+            result.moves.push_back( move );
+            result.cost += move.getCost( );
+            cube = move * cube;
+          } catch( std::out_of_range& ) {
+            valid = false;
+          }
+        }
+        valid = valid && std::any_of( data.goal_cubes.begin( ), data.goal_cubes.end( ), [ &cube ]( const Cube& goal ) { return cube == goal; } );
+        if( valid ) {
+          result.rotations = rotations.str( );
+          if( data.config.displaySolutionHuman( ) ) {
+            data.os << data.words[ 0 ] << " " << data.words[ 1 ] << " " << data.words[ 2 ] << std::endl;
+            data.os << "Found cached solution." << std::endl;
+            data.os << "rotate " << result.rotations << std::endl;
+            data.os << "Cost: " << result.cost << std::endl;
             data.os << std::endl;
           }
-          if( data.config.displaySolutionMachine( ) ) {
-            generated_nodes += algorithm->GetNumberNodesGenerated( );
-            stored_nodes = std::max( stored_nodes, algorithm->GetMaxNodesStored( ) );
+          return EXIT_OK;
+        }
+        cache.rejectHit( );
+      }
+
+      int ok = search_core( data, result );
+      if( ok != EXIT_OK || !result.solved ) {
+        return ok;
+      }
+      entry.cost = result.cost;
+      entry.moves.clear( );
+      for( auto it = result.moves.begin( ); it != result.moves.end( ); it++ ) {
+        std::string name = symmetry.findMoveName( *it );
+        if( name == "" ) {
+          return EXIT_OK;
+        }
+        entry.moves.push_back( symmetry.toCanonical( rotation, name ) );
+      }
+      cache.store( key, entry );
+      return EXIT_OK;
+    }
+
+    /*********************************************
+     * Automatic selection
+     */
+
+    /* the estimate must stay a small part of any search */
+    static const double AUTO_ESTIMATE_SECONDS = 0.005;
+    static const unsigned int AUTO_PROBES = 32;
+    static const unsigned int AUTO_GREEDY_PROBES = 4;
+
+    /* Estimated nodes of a tree search with f bound threshold, from the
+     * estimates at thresholds, growing by the last ratio beyond them.
+     */
+    static double predict_nodes( const std::vector< double >& thresholds, const std::vector< double >& nodes,
+                                 const double branching, const double threshold ) {
+      size_t i;
+      for( i = 0; i < thresholds.size( ); i++ ) {
+        if( thresholds[ i ] >= threshold ) {
+          return nodes[ i ];
+        }
+      }
+      const size_t last = nodes.size( ) - 1;
+      const double ratio = last > 0 ? std::max( 1.0, nodes[ last ] / nodes[ last - 1 ] ) : branching;
+      return nodes[ last ] * std::pow( ratio, threshold - thresholds[ last ] );
+    }
+
+    /* Replaces "search auto" or "plan auto" with the algorithm and
+     * frontier to run, and displays the estimate behind the choice.
+     *
+     * Knuth's estimator predicts the nodes of a tree search bounded by
+     * each f threshold from the initial heuristic up to astar_limit, for
+     * a few milliseconds.  A probe that meets a goal, or a greedy walk
+     * from the cube that reaches one first, bounds the solution cost;
+     * without one, the cost is taken as the deepest bound the budget
+     * affords.  graph astar is chosen if its nodes at that cost fit the
+     * generation, storage and memory limits and auto_time_limit, tree al
+     * if a depth first search to astar_limit fits the generation and time
+     * limits, and graph greedy otherwise.  The tree counts include the
+     * duplicate states graph astar stores only once, so they overestimate
+     * its nodes and lean the choice away from it.
+     */
+    static int choose_auto_search( AppData& data ) {
+      cgl::rubiks::State initial_state( data.cube );
+      std::unique_ptr< ai::Search::Problem > problem;
+      if( data.words[ 0 ] == "plan" ) {
+        PlanProblem *plan_problem = new PlanProblem( &initial_state, *data.plan_action_set, data.goal_cubes );
+        plan_problem->setHeuristic( static_cast< Problem::HeuristicEnum >( data.config.heuristic( ) ) );
+        problem.reset( plan_problem );
+      } else {
+        Problem *search_problem = new Problem( &initial_state, data.goal_cubes );
+        search_problem->setAllowedMoves( data.move_set->getMoves( ) );
+        search_problem->setHeuristic( static_cast< Problem::HeuristicEnum >( data.config.heuristic( ) ) );
+        problem.reset( search_problem );
+      }
+
+      const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now( ) +
+        std::chrono::duration_cast< std::chrono::steady_clock::duration >( std::chrono::duration< double >( AUTO_ESTIMATE_SECONDS ) );
+      /* seeded from this search's stream, so config seed repeats the choice */
+      ai::Search::Estimator estimator( problem.get( ), data.random.next( ) );
+      const double h = problem->Heuristic( &initial_state );
+      const double limit = data.config.aStarLimit( );
+      const size_t node_bytes = estimator.NodeBytes( );
+      std::vector< ai::Search::Action * > actions = problem->Actions( &initial_state );
+      const double branching = std::max< size_t >( 1, actions.size( ) );
+      for( auto it = actions.begin( ); it != actions.end( ); it++ ) {
+        delete *it;
+      }
+
+      /* greedy walks may find a solution, bounding the cost A* searches to */
+      unsigned int probes;
+      for( probes = 0; probes < AUTO_GREEDY_PROBES && estimator.GetGoalCost( ) > std::ceil( h ); probes++ ) {
+        estimator.GreedyProbe( std::min( estimator.GetGoalCost( ), limit ) );
+      }
+
+      /* nodes the generation limit and the time limit allow, at the probes' speed */
+      double budget = data.config.generationLimit( ) > 0 ? data.config.generationLimit( ) : std::numeric_limits< double >::infinity( );
+      std::vector< double > thresholds, nodes;
+      double threshold;
+      for( threshold = std::max( 0.0, std::ceil( h ) ); threshold <= limit; threshold += 1.0 ) {
+        if( !thresholds.empty( ) && std::chrono::steady_clock::now( ) >= deadline ) {
+          break;
+        }
+        thresholds.push_back( threshold );
+        nodes.push_back( estimator.EstimateNodes( threshold, AUTO_PROBES, deadline ) );
+        probes += estimator.GetProbeCount( );
+        if( estimator.GetNodesGenerated( ) > 0 && estimator.GetSeconds( ) > 0 ) {
+          budget = std::min( budget, estimator.GetNodesGenerated( ) / estimator.GetSeconds( ) * data.config.autoTimeLimit( ) );
+        }
+        if( estimator.GetGoalCost( ) <= threshold || nodes.back( ) > budget ) {
+          break;
+        }
+      }
+
+      /* graph search generates every child of the nodes it expands, tree al only those within the bound */
+      double solution_cost = std::min( estimator.GetGoalCost( ), limit );
+      if( estimator.GetGoalCost( ) > limit && !thresholds.empty( ) ) {
+        /* no goal seen: plan for the deepest bound the budget affords */
+        solution_cost = thresholds[ 0 ];
+        for( threshold = thresholds[ 0 ] + 1.0; threshold <= limit; threshold += 1.0 ) {
+          if( predict_nodes( thresholds, nodes, branching, threshold ) * branching > budget ) {
+            break;
           }
+          solution_cost = threshold;
         }
+      }
+      /* the initial heuristic is over astar_limit when no bound was estimated */
+      double astar_nodes = std::numeric_limits< double >::infinity( );
+      double al_nodes = std::numeric_limits< double >::infinity( );
+      if( !thresholds.empty( ) ) {
+        astar_nodes = predict_nodes( thresholds, nodes, branching, solution_cost ) * branching;
+        al_nodes = predict_nodes( thresholds, nodes, branching, limit );
+      }
+      const double astar_mb = astar_nodes * node_bytes / ( 1024 * 1024 );
+      std::string algorithm, frontier;
+      if( astar_nodes <= budget &&
+          ( data.config.storageLimit( ) == 0 || astar_nodes <= data.config.storageLimit( ) ) &&
+          ( data.config.memoryLimit( ) == 0 || astar_mb <= data.config.memoryLimit( ) ) ) {
+        algorithm = "graph";
+        frontier = "astar";
+      } else if( al_nodes <= budget ) {
+        algorithm = "tree";
+        frontier = "al";
+      } else {
+        algorithm = "graph";
+        frontier = "greedy";
+      }
 
-        delete algorithm;
-        algorithm = 0;
+      data.os << "auto"
+              << " h " << h
+              << " astar_limit " << limit
+              << " goal_cost " << estimator.GetGoalCost( )
+              << " solution_cost " << solution_cost
+              << " probes " << probes
+              << " estimate_ms " << estimator.GetSeconds( ) * 1000.0
+              << " node_budget " << budget
+              << " astar_nodes " << astar_nodes
+              << " astar_mb " << astar_mb
+              << " al_nodes " << al_nodes
+              << " chose " << algorithm << " " << frontier << std::endl;
+      data.words = { data.words[ 0 ], algorithm, frontier };
+      return EXIT_OK;
+    }
+
+    /*
+     * Automatic selection
+     *********************************************/
+
+    static int search_aux( AppData& data ) {
+      if( data.words.size( ) == 2 && data.words[ 1 ] == "auto" ) {
+        int ok = choose_auto_search( data );
+        if( ok != EXIT_OK ) {
+          return ok;
+        }
+      }
+      SearchResult result;
+      int ok;
+      if( data.config.solutionCache( ) ) {
+        ok = cached_search( data, result );
+      } else {
+        ok = search_core( data, result );
+      }
+      if( ok != EXIT_OK ) {
+        return ok;
       }
-      if( !solved ) {
+
+      if( !result.solved ) {
         data.solution_valid = false;
       } else {
         data.solution_valid = true;
-        data.solution = rotations.str( );
+        data.solution = result.rotations;
+        if( data.config.applySolution( ) ) {
+          apply_moves( data.cube, result.moves );
+        }
       }
 
+      const std::string command = data.words[ 0 ] + " " + data.words[ 1 ] + " " + data.words[ 2 ];
+      remember_statistics( data, command, result );
       if( data.config.displaySolutionMachine( ) ) {
-        if( !solved ) {
-          machine_stream << "F " << generated_nodes << " " << stored_nodes;
-        } else {
-          machine_stream << "T " << generated_nodes << " " << stored_nodes << " ";
-          machine_stream << cost << " ";
-          machine_stream << "rotate " << rotations.str( );
-        }
-        data.os << machine_stream.str( ) << std::endl;
+        show_machine_result( data, command, result );
       }
       return EXIT_OK;
     }
@@ -246,6 +614,338 @@ namespace cgl {
       return search_aux( data );
     }
 
+    /* true if cube matches the goals of stages 0 through last */
+    static bool stages_hold( const std::vector< Cube >& stages, const unsigned int last, const Cube& cube ) {
+      unsigned int stage;
+      for( stage = 0; stage <= last; stage++ ) {
+        if( !( cube == stages[ stage ] ) ) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /* Solves each stage in order, starting from the previous stage's result.
+     * A stage is solved without undoing the earlier ones: it is searched
+     * for the goals of all stages so far, and a remembered solution is
+     * used only if it keeps them too.  Remembered stage solutions are
+     * tried before searching.
+     */
+    static int hla_solve_aux( AppData& data, SearchResult& result, unsigned int& searched, unsigned int& remembered ) {
+      const std::vector< Cube >& stages = data.stage_set.getStages( );
+      // remembered moves are only valid with the moves or plan actions that found them
+      const std::string method = data.words[ 0 ] + " " + CubeSymmetry( search_vocabulary( data ), false ).getMovesHash( ) + search_conditions_hash( data );
+      std::stringstream rotations;
+      Cube goal = stages[ 0 ];
+      unsigned int stage;
+      for( stage = 0; stage < stages.size( ); stage++ ) {
+        try {
+          goal.mergeCube( stages[ stage ] );
+        } catch( Exception& ) {
+          if( data.config.displaySolutionHuman( ) ) {
+            data.os << "Stage " << stage + 1 << " conflicts with an earlier stage." << std::endl;
+          }
+          return EXIT_OK;
+        }
+        if( data.cube == goal ) {
+          continue;
+        }
+
+        std::vector< Move > moves;
+        if( data.stage_set.findSolution( stage, method, data.cube, moves ) ) {
+          Cube cube = data.cube;
+          apply_moves( cube, moves );
+          // the memo key only covers this stage's facelets, so a remembered
+          // solution may undo an earlier stage
+          if( stages_hold( stages, stage, cube ) ) {
+            remembered++;
+            if( data.config.displaySolutionHuman( ) ) {
+              data.os << "Stage " << stage + 1 << " remembered." << std::endl;
+            }
+          } else {
+            moves.clear( );
+          }
+        }
+
+        if( moves.size( ) == 0 ) {
+          if( data.config.displaySolutionHuman( ) ) {
+            data.os << "Stage " << stage + 1 << " searching." << std::endl;
+          }
+          data.goal_cubes.assign( 1, goal );
+          SearchResult stage_result;
+          int ok = search_core( data, stage_result );
+          if( ok != EXIT_OK ) {
+            return ok;
+          }
+          searched++;
+          result.generated_nodes += stage_result.generated_nodes;
+          result.stored_nodes = std::max( result.stored_nodes, stage_result.stored_nodes );
+          result.statistics.Add( stage_result.statistics );
+          if( !stage_result.solved ) {
+            if( data.config.displaySolutionHuman( ) ) {
+              data.os << "Could not solve stage " << stage + 1 << "." << std::endl;
+            }
+            return EXIT_OK;
+          }
+          moves = stage_result.moves;
+          data.stage_set.storeSolution( stage, method, data.cube, moves );
+        }
+
+        for( auto it = moves.begin( ); it != moves.end( ); it++ ) {
+          if( result.moves.size( ) > 0 ) {
+            rotations << " ";
+          }
+          rotations << it->getName( );
+          result.moves.push_back( *it );
+          result.cost += it->getCost( );
+        }
+        apply_moves( data.cube, moves );
+      }
+      result.solved = true;
+      result.rotations = rotations.str( );
+      return EXIT_OK;
+    }
+
+    int hla_solve( AppData& data ) {
+      if( data.words.size( ) < 4 ) {
+        return EXIT_USAGE;
+      }
+      if( data.stage_set.size( ) == 0 ) {
+        data.os << "No stages defined.  Use init stages." << std::endl;
+        return EXIT_USAGE_HELP;
+      }
+
+      std::vector< std::string > words = data.words;
+      std::vector< Cube > goal_cubes = data.goal_cubes;
+      Cube cube = data.cube;
+      data.words.assign( words.begin( ) + 1, words.end( ) );
+
+      SearchResult result;
+      result.solved = false;
+      result.generated_nodes = 0;
+      result.stored_nodes = 0;
+      result.cost = 0.0;
+      unsigned int searched = 0;
+      unsigned int remembered = 0;
+      int ok = hla_solve_aux( data, result, searched, remembered );
+
+      data.words = words;
+      data.goal_cubes = goal_cubes;
+      data.cube = cube;
+      if( ok != EXIT_OK ) {
+        return ok;
+      }
+
+      if( !result.solved ) {
+        data.solution_valid = false;
+      } else {
+        data.solution_valid = true;
+        data.solution = result.rotations;
+        if( data.config.applySolution( ) ) {
+          apply_moves( data.cube, result.moves );
+        }
+      }
+
+      if( data.config.displaySolutionHuman( ) ) {
+        if( result.solved ) {
+          data.os << "Found solution." << std::endl;
+          data.os << "rotate " << result.rotations << std::endl;
+          data.os << "Cost: " << result.cost << std::endl;
+        } else {
+          data.os << "Could not find solution." << std::endl;
+        }
+        data.os << "Stages searched " << searched << ", remembered " << remembered << "." << std::endl;
+        data.os << std::endl;
+      }
+      const std::string command = words[ 0 ] + " " + words[ 1 ] + " " + words[ 2 ] + " " + words[ 3 ];
+      remember_statistics( data, command, result );
+      if( data.config.displaySolutionMachine( ) ) {
+        show_machine_result( data, command, result );
+      }
+      return EXIT_OK;
+    }
+
+    /*********************************************
+     * Batch solving
+     */
+    struct BatchItem {
+      Cube        cube;
+      std::string result;  // machine readable line, without newline
+      bool        done;
+    };
+
+    struct BatchQueue {
+      std::vector< BatchItem > items;
+      std::atomic< unsigned int > next_item;
+      std::mutex mutex;
+      std::condition_variable item_done;
+      Random random; // item i uses random.stream( i )
+    };
+
+    /* Each worker has its own copy of the application data, so the
+     * problems, algorithms and ids depth of concurrent searches are
+     * independent.  Items are claimed in order from the shared queue.
+     */
+    static void batch_worker( const AppData& data, const std::vector< std::string >& spec, BatchQueue& queue ) {
+      std::stringstream os;
+      AppData worker( data.is, os );
+      worker.config = data.config;
+      worker.config.setDisplaySolutionMachine( );
+      worker.goal_cubes = data.goal_cubes;
+      worker.move_set = data.move_set;
+      worker.cube_set = data.cube_set;
+      worker.plan_action_set = data.plan_action_set;
+      // the writer is shared by every worker, and interleaves their records
+      worker.trace = data.trace;
+      worker.words = spec;
+      const std::string command = spec[ 0 ] + " " + spec[ 1 ] + " " + spec[ 2 ];
+
+      unsigned int i;
+      while( ( i = queue.next_item++ ) < queue.items.size( ) ) {
+        worker.cube = queue.items[ i ].cube;
+        /* the same item gets the same stream whichever worker solves it */
+        worker.random = queue.random.stream( i );
+        std::stringstream line;
+        SearchResult result;
+        auto start = std::chrono::steady_clock::now( );
+        int ok;
+        try {
+          ok = search_core( worker, result );
+        } catch( std::exception& ) {
+          // an exception leaving the thread would terminate the program
+          ok = EXIT_THROW;
+        }
+        std::chrono::duration< double > seconds = std::chrono::steady_clock::now( ) - start;
+        if( ok != EXIT_OK ) {
+          line << command << " E";
+        } else {
+          write_machine_result( line, worker.config, command, result );
+        }
+        line << " time " << seconds.count( );
+
+        std::lock_guard< std::mutex > lock( queue.mutex );
+        queue.items[ i ].result = line.str( );
+        queue.items[ i ].done = true;
+        queue.item_done.notify_all( );
+      }
+    }
+
+    int read_cube_file( AppData& data, std::istream& is, std::vector< Cube >& cubes ) {
+      std::vector< std::string > words = data.words;
+      std::string text;
+      int line_number = 0;
+      int ok = EXIT_OK;
+      while( ok == EXIT_OK && std::getline( is, text ) ) {
+        line_number++;
+        std::stringstream ss( text );
+        data.words.clear( );
+        std::string word;
+        while( ss >> word ) {
+          data.words.push_back( word );
+        }
+        if( data.words.size( ) == 0 || data.words[ 0 ][ 0 ] == '#' ) {
+          continue;
+        }
+
+        Cube cube;
+        if( data.move_set->moveExists( data.words[ 0 ] ) ) {
+          cube = data.cube;
+          for( auto it = data.words.begin( ); it != data.words.end( ); it++ ) {
+            if( !data.move_set->moveExists( *it ) ) {
+              data.os << "Unexpected move on line " << line_number << ": ( " << *it << " )" << std::endl;
+              ok = EXIT_USAGE_HELP;
+              break;
+            }
+            cube = data.move_set->getMove( *it ) * cube;
+          }
+        } else {
+          ok = init_cube( data, cube, 0, data.words.size( ) );
+          if( ok != EXIT_OK ) {
+            data.os << "Bad cube on line " << line_number << "." << std::endl;
+          }
+        }
+        cubes.push_back( cube );
+      }
+      data.words = words;
+      return ok;
+    }
+
+    static int read_batch_items( AppData& data, std::istream& is, std::vector< BatchItem >& items ) {
+      std::vector< Cube > cubes;
+      int ok = read_cube_file( data, is, cubes );
+      items.resize( cubes.size( ) );
+      size_t i;
+      for( i = 0; i < cubes.size( ); i++ ) {
+        items[ i ].cube = cubes[ i ];
+        items[ i ].done = false;
+      }
+      return ok;
+    }
+
+    int batch( AppData& data ) {
+      if( data.words.size( ) < 5 ) {
+        return EXIT_USAGE;
+      }
+      std::vector< std::string > spec( data.words.begin( ) + 2, data.words.begin( ) + 5 );
+      if( ( spec[ 0 ] != "search" && spec[ 0 ] != "plan" ) ||
+          ( spec[ 1 ] != "tree" && spec[ 1 ] != "graph" ) ) {
+        return EXIT_USAGE;
+      }
+      {
+        /* check the frontier before starting any workers */
+        std::vector< std::string > words = data.words;
+        data.words = spec;
+        ai::Search::Frontier *frontier = 0;
+        int ok = create_search_frontier( data, &frontier );
+        delete frontier;
+        data.words = words;
+        if( ok != EXIT_OK ) {
+          return ok;
+        }
+      }
+
+      std::ifstream fin( data.words[ 1 ] );
+      if( !fin ) {
+        data.os << "Unable to open the file '" << data.words[ 1 ] << "'." << std::endl;
+        return EXIT_USAGE_HELP;
+      }
+      BatchQueue queue;
+      queue.next_item = 0;
+      queue.random.seed( data.random.next( ) );
+      int ok = read_batch_items( data, fin, queue.items );
+      if( ok != EXIT_OK ) {
+        return ok;
+      }
+
+      unsigned int num_threads = data.config.workerThreads( );
+      num_threads = std::min( num_threads, static_cast< unsigned int >( queue.items.size( ) ) );
+      std::vector< std::thread > workers;
+      unsigned int i;
+      for( i = 0; i < num_threads; i++ ) {
+        workers.push_back( std::thread( batch_worker, std::cref( data ), std::cref( spec ), std::ref( queue ) ) );
+      }
+
+      /* display results in input order as soon as they are ready */
+      for( i = 0; i < queue.items.size( ); i++ ) {
+        std::unique_lock< std::mutex > lock( queue.mutex );
+        if( !queue.items[ i ].done ) {
+          data.os << std::flush;
+          queue.item_done.wait( lock, [ &queue, i ] { return queue.items[ i ].done; } );
+        }
+        data.os << queue.items[ i ].result << '\n';
+      }
+      data.os << std::flush;
+
+      for( auto it = workers.begin( ); it != workers.end( ); it++ ) {
+        it->join( );
+      }
+      return EXIT_OK;
+    }
+
+    /*
+     * Batch solving
+     *********************************************/
+
     /*
      * Solving
      *********************************************/
@@ -0,0 +1,39 @@
+#ifndef _CGLRUBIKSSEARCH_H_
+#define _CGLRUBIKSSEARCH_H_
+
+#include "cglRubiksCube.h"
+#include "ai_search.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace cgl {
+  namespace rubiks {
+
+    struct AppData;
+
+    struct SearchResult {
+      bool                solved;
+      unsigned int        generated_nodes;
+      size_t              stored_nodes;
+      double              cost;
+      std::string         rotations;
+      std::vector< Move > moves;
+      ai::Search::Statistics statistics; // summed over ids iterations
+    };
+
+    /* Runs the search described by data.words[ 0 .. 2 ] from data.cube to
+     * data.goal_cubes, including ids iterations and human readable output.
+     * Does not apply the solution or display the machine readable line.
+     * Used by search, plan, hla_solve and batch, and by the end to end
+     * benchmarks.
+     */
+    int search_core( AppData& data, SearchResult& result );
+
+  }
+}
+
+#endif /* _CGLRUBIKSSEARCH_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
@@ -0,0 +1,188 @@
+#include "cglRubiksCommand.h"
+#include "cglRubiksAppData.h"
+#include "cglRubiksTokenizer.h"
+#include "ai_agent.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <set>
+#include <list>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*********************************************
+     * Serving
+     */
+    struct ServerState {
+      std::atomic< bool > shutdown;
+      std::mutex mutex;
+      std::set< ai::Agent::Socket * > clients;
+      Random random; // connection i uses random.stream( i )
+    };
+
+    struct Connection {
+      std::thread         thread;
+      std::atomic< bool > finished;
+    };
+
+    /* The commands a connection may run, and the most words each may
+     * have.  Reading or writing files and starting another server are
+     * left out, so shuffle and trace are limited to their forms without
+     * a filename.  cache is left out, as the cache is shared by every
+     * connection.
+     */
+    static const std::map< std::string, unsigned int > SERVED_COMMANDS = {
+      { "echo", UINT_MAX }, { "config", UINT_MAX }, { "init", UINT_MAX },
+      { "shuffle", 3 }, { "equal", UINT_MAX }, { "search", UINT_MAX },
+      { "plan", UINT_MAX }, { "hla_solve", UINT_MAX }, { "profile_heuristic", UINT_MAX },
+      { "trace", 2 }, { "rotate", UINT_MAX }, { "moves", UINT_MAX },
+      { "show", UINT_MAX }, { "define", UINT_MAX }, { "help", UINT_MAX },
+      { "repeat", UINT_MAX }, { "end", UINT_MAX }, { "exit_if", UINT_MAX },
+      { "quit", UINT_MAX }, { "exit", UINT_MAX },
+    };
+
+    static void restrict_actions( AppData& state ) {
+      auto it = state.actions.begin( );
+      while( it != state.actions.end( ) ) {
+        auto served = SERVED_COMMANDS.find( it->first );
+        if( served == SERVED_COMMANDS.end( ) ) {
+          it = state.actions.erase( it );
+        } else {
+          it->second.max_words = served->second;
+          it++;
+        }
+      }
+    }
+
+    /* Messages are one or more command lines.  The connection keeps its
+     * own state between messages, starting from a copy of the server's
+     * that shares its sets until the connection changes them.
+     */
+    static void serve_connection( const AppData& data, ai::Agent::Socket *client, ServerState& server, const unsigned int index, std::atomic< bool >& finished ) {
+      std::stringstream is;
+      std::stringstream os;
+      AppData state( is, os );
+      state.copyState( data );
+      restrict_actions( state );
+      state.random = server.random.stream( index );
+      state.config.disablePrompt( );
+      state.config.setDisplaySolutionMachine( );
+
+      std::string message;
+      while( !state.done && !server.shutdown && client->Recv( message ) ) {
+        std::stringstream words( message );
+        std::string word;
+        if( ( words >> word ) && word == "shutdown" && !( words >> word ) ) {
+          server.shutdown = true;
+          client->Send( "shutdown\n" );
+          break;
+        }
+
+        is.clear( );
+        is.str( message );
+        os.str( "" );
+        try {
+          process_input_stream_aux( state );
+        } catch( Exception& e ) {
+          os << e.what( ) << std::endl;
+        } catch( std::exception& e ) {
+          // out_of_range, bad_alloc and the like must not reach the
+          // thread boundary, which would end every connection
+          os << "Error: " << e.what( ) << std::endl;
+        }
+        if( !client->Send( os.str( ) ) ) {
+          break;
+        }
+      }
+
+      std::lock_guard< std::mutex > lock( server.mutex );
+      server.clients.erase( client );
+      delete client;
+      finished = true;
+    }
+
+    /* joins the threads of connections that have ended */
+    static void reap_connections( std::list< Connection >& connections ) {
+      auto it = connections.begin( );
+      while( it != connections.end( ) ) {
+        if( it->finished ) {
+          it->thread.join( );
+          it = connections.erase( it );
+        } else {
+          it++;
+        }
+      }
+    }
+
+    int serve( AppData& data ) {
+      if( data.words.size( ) != 2 ) {
+        return EXIT_USAGE;
+      }
+      int port = 0;
+      if( !parse_number( data.words[ 1 ], port ) || port <= 0 ) {
+        return EXIT_USAGE_HELP;
+      }
+
+      ai::Agent::Socket listener;
+      if( !listener.Listen( port, true ) ) {
+        data.os << "Unable to listen on port " << port << "." << std::endl;
+        return EXIT_USAGE_HELP;
+      }
+      data.os << "Serving on port " << port << "." << std::endl;
+      /* connections share the cache, but only the server's config sizes it */
+      data.solution_cache->setCapacity( data.config.cacheCapacity( ) );
+
+      ServerState server;
+      server.shutdown = false;
+      server.random.seed( data.random.next( ) );
+      std::list< Connection > connections;
+      unsigned int index = 0;
+      std::vector< ai::Agent::Socket * > sockets = { &listener };
+      std::vector< ai::Agent::Socket * > ready;
+      while( !server.shutdown ) {
+        reap_connections( connections );
+        /* wake up regularly to notice a shutdown request */
+        if( !ai::Agent::Socket::Select( sockets, ready, 0.1 ) || ready.size( ) == 0 ) {
+          continue;
+        }
+        ai::Agent::Socket *client = listener.Accept( );
+        if( !client ) {
+          continue;
+        }
+        /* replies are small, send them without waiting to coalesce */
+        int no_delay = 1;
+        setsockopt( client->GetSocket( ), IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof( no_delay ) );
+        std::lock_guard< std::mutex > lock( server.mutex );
+        server.clients.insert( client );
+        connections.emplace_back( );
+        Connection& connection = connections.back( );
+        connection.finished = false;
+        connection.thread = std::thread( serve_connection, std::cref( data ), client, std::ref( server ), index++, std::ref( connection.finished ) );
+      }
+
+      {
+        /* unblock connections waiting for their next message */
+        std::lock_guard< std::mutex > lock( server.mutex );
+        for( auto it = server.clients.begin( ); it != server.clients.end( ); it++ ) {
+          ::shutdown( ( *it )->GetSocket( ), SHUT_RDWR );
+        }
+      }
+      for( auto it = connections.begin( ); it != connections.end( ); it++ ) {
+        it->thread.join( );
+      }
+      data.os << "Server stopped." << std::endl;
+      return EXIT_OK;
+    }
+
+    /*
+     * Serving
+     *********************************************/
+
+  }
+}
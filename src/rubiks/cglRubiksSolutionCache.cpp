@@ -0,0 +1,299 @@
+#include "cglRubiksSolutionCache.h"
+#include <cstdint>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+namespace cgl {
+  namespace rubiks {
+
+    /**************************************************************
+     *
+     * CubeSymmetry class
+     *
+     */
+
+    CubeSymmetry::CubeSymmetry( const std::map< std::string, Move >& moves, const bool allow_symmetry )
+      : mAllowSymmetry( allow_symmetry ) {
+      std::stringstream ss;
+      for( auto it = moves.begin( ); it != moves.end( ); it++ ) {
+        if( mNamesByTransform.count( it->second.getTransform( ) ) == 0 ) {
+          mNamesByTransform[ it->second.getTransform( ) ] = it->first;
+        }
+        ss << it->first << ":" << it->second.getCost( ) << ":";
+        for( auto t = it->second.getTransform( ).begin( ); t != it->second.getTransform( ).end( ); t++ ) {
+          ss << *t << ",";
+        }
+      }
+      mMovesHash = hashText( ss.str( ) );
+
+      /* all rotations, as the closure of x and y */
+      std::vector< Move > rotations( 1, Move( Move::M_IDENTITY ) );
+      if( allow_symmetry ) {
+        const Move generators[ 2 ] = { Move( Move::M_X ), Move( Move::M_Y ) };
+        std::set< std::vector< int > > seen = { rotations[ 0 ].getTransform( ) };
+        unsigned int i;
+        for( i = 0; i < rotations.size( ); i++ ) {
+          for( const Move& generator : generators ) {
+            Move rotation = generator * rotations[ i ];
+            if( seen.insert( rotation.getTransform( ) ).second ) {
+              rotations.push_back( rotation );
+            }
+          }
+        }
+      }
+
+      /* keep the rotations that map every move onto a move */
+      for( auto r = rotations.begin( ); r != rotations.end( ); r++ ) {
+        const std::vector< int >& q = r->getTransform( );
+        std::vector< int > q_inverse( q.size( ) );
+        unsigned int p;
+        for( p = 0; p < q.size( ); p++ ) {
+          q_inverse[ q[ p ] ] = p;
+        }
+        std::map< std::string, std::string > to_canonical;
+        std::map< std::string, std::string > from_canonical;
+        bool valid = true;
+        for( auto it = moves.begin( ); it != moves.end( ) && valid; it++ ) {
+          /* rotate, move, rotate back: position p goes to q[ t[ q_inverse[ p ] ] ] */
+          const std::vector< int >& t = it->second.getTransform( );
+          std::vector< int > conjugate( t.size( ) );
+          for( p = 0; p < t.size( ); p++ ) {
+            conjugate[ p ] = q[ t[ q_inverse[ p ] ] ];
+          }
+          auto found = mNamesByTransform.find( conjugate );
+          if( found == mNamesByTransform.end( ) ) {
+            valid = false;
+          } else {
+            to_canonical[ it->first ] = found->second;
+            from_canonical[ found->second ] = it->first;
+          }
+        }
+        if( valid ) {
+          mRotations.push_back( *r );
+          mToCanonical.push_back( to_canonical );
+          mFromCanonical.push_back( from_canonical );
+        }
+      }
+    }
+
+    unsigned int CubeSymmetry::getNumRotations( ) const {
+      return mRotations.size( );
+    }
+
+    std::string CubeSymmetry::canonicalize( const std::vector< Cube >& goals, const Cube& cube, unsigned int& rotation ) const {
+      std::string best;
+      unsigned int i;
+      for( i = 0; i < mRotations.size( ); i++ ) {
+        std::string s = relabel( goals, cube, mRotations[ i ] );
+        if( i == 0 || s < best ) {
+          best = s;
+          rotation = i;
+        }
+      }
+      return best;
+    }
+
+    const std::string& CubeSymmetry::toCanonical( const unsigned int rotation, const std::string& move_name ) const {
+      return mToCanonical[ rotation ].at( move_name );
+    }
+
+    const std::string& CubeSymmetry::fromCanonical( const unsigned int rotation, const std::string& move_name ) const {
+      return mFromCanonical[ rotation ].at( move_name );
+    }
+
+    std::string CubeSymmetry::findMoveName( const Move& move ) const {
+      auto it = mNamesByTransform.find( move.getTransform( ) );
+      if( it == mNamesByTransform.end( ) ) {
+        return "";
+      }
+      return it->second;
+    }
+
+    std::string CubeSymmetry::getMovesHash( ) const {
+      return mMovesHash;
+    }
+
+    std::string CubeSymmetry::hashText( const std::string& text ) {
+      std::uint64_t hash = 14695981039346656037ULL;
+      for( auto c = text.begin( ); c != text.end( ); c++ ) {
+        hash = ( hash ^ static_cast< unsigned char >( *c ) ) * 1099511628211ULL;
+      }
+      std::stringstream hs;
+      hs << std::hex << std::setw( 16 ) << std::setfill( '0' ) << hash;
+      return hs.str( );
+    }
+
+    /* Colors are renamed a, b, c, ... in order of first appearance, goals
+     * first.  Wildcards are kept.
+     */
+    std::string CubeSymmetry::relabel( const std::vector< Cube >& goals, const Cube& cube, const Move& rotation ) const {
+      std::map< Facelet, char > labels;
+      std::string s;
+      std::vector< Cube > cubes = goals;
+      cubes.push_back( cube );
+      for( auto it = cubes.begin( ); it != cubes.end( ); it++ ) {
+        const Cube rotated = rotation * ( *it );
+        const std::vector< Facelet >& facelets = rotated.getFacelets( );
+        for( auto f = facelets.begin( ); f != facelets.end( ); f++ ) {
+          if( *f == '*' || !mAllowSymmetry ) {
+            s += *f;
+          } else {
+            auto label = labels.find( *f );
+            if( label == labels.end( ) ) {
+              label = labels.insert( std::make_pair( *f, static_cast< char >( 'a' + labels.size( ) ) ) ).first;
+            }
+            s += label->second;
+          }
+        }
+        s += '/';
+      }
+      return s;
+    }
+
+    /*
+     *
+     * CubeSymmetry class
+     *
+     **************************************************************/
+
+    /**************************************************************
+     *
+     * SolutionCache class
+     *
+     */
+
+    SolutionCache::SolutionCache( )
+      : mCapacity( 100000 ), mLookups( 0 ), mHits( 0 ), mStores( 0 ), mLoaded( 0 ), mEvictions( 0 ) {
+      // empty
+    }
+
+    SolutionCache::~SolutionCache( ) {
+      // empty
+    }
+
+    void SolutionCache::clear( ) {
+      std::lock_guard< std::mutex > lock( mMutex );
+      mEntries.clear( );
+      mIndex.clear( );
+      mLookups = mHits = mStores = mLoaded = mEvictions = 0;
+    }
+
+    void SolutionCache::setCapacity( const size_t capacity ) {
+      std::lock_guard< std::mutex > lock( mMutex );
+      mCapacity = capacity;
+      while( mEntries.size( ) > mCapacity ) {
+        mIndex.erase( mEntries.back( ).first );
+        mEntries.pop_back( );
+        mEvictions++;
+      }
+    }
+
+    /* Each line is key, cost and the space separated moves, separated by tabs. */
+    bool SolutionCache::openFile( const std::string& filename ) {
+      std::lock_guard< std::mutex > lock( mMutex );
+      if( mFile.is_open( ) ) {
+        mFile.close( );
+      }
+      std::ifstream fin( filename );
+      std::string line;
+      while( fin && std::getline( fin, line ) ) {
+        std::stringstream ss( line );
+        std::string key, cost, moves;
+        if( !std::getline( ss, key, '\t' ) || !std::getline( ss, cost, '\t' ) ) {
+          continue;
+        }
+        std::getline( ss, moves );
+        Entry entry;
+        std::stringstream cs( cost );
+        if( !( cs >> entry.cost ) ) {
+          continue;
+        }
+        std::stringstream ms( moves );
+        std::string move;
+        while( ms >> move ) {
+          entry.moves.push_back( move );
+        }
+        insert( key, entry );
+        mLoaded++;
+      }
+      mFile.open( filename, std::ios::app );
+      if( !mFile ) {
+        return false;
+      }
+      mFilename = filename;
+      return true;
+    }
+
+    bool SolutionCache::lookup( const std::string& key, Entry& entry ) {
+      std::lock_guard< std::mutex > lock( mMutex );
+      mLookups++;
+      auto it = mIndex.find( key );
+      if( it == mIndex.end( ) ) {
+        return false;
+      }
+      mEntries.splice( mEntries.begin( ), mEntries, it->second );
+      entry = it->second->second;
+      mHits++;
+      return true;
+    }
+
+    void SolutionCache::store( const std::string& key, const Entry& entry ) {
+      std::lock_guard< std::mutex > lock( mMutex );
+      insert( key, entry );
+      mStores++;
+      if( mFile.is_open( ) ) {
+        mFile << key << '\t' << entry.cost << '\t';
+        for( auto it = entry.moves.begin( ); it != entry.moves.end( ); it++ ) {
+          if( it != entry.moves.begin( ) ) {
+            mFile << ' ';
+          }
+          mFile << *it;
+        }
+        mFile << '\n' << std::flush;
+      }
+    }
+
+    void SolutionCache::rejectHit( ) {
+      std::lock_guard< std::mutex > lock( mMutex );
+      mHits--;
+    }
+
+    void SolutionCache::insert( const std::string& key, const Entry& entry ) {
+      auto it = mIndex.find( key );
+      if( it != mIndex.end( ) ) {
+        it->second->second = entry;
+        mEntries.splice( mEntries.begin( ), mEntries, it->second );
+        return;
+      }
+      mEntries.push_front( std::make_pair( key, entry ) );
+      mIndex[ key ] = mEntries.begin( );
+      while( mEntries.size( ) > mCapacity ) {
+        mIndex.erase( mEntries.back( ).first );
+        mEntries.pop_back( );
+        mEvictions++;
+      }
+    }
+
+    void SolutionCache::displayStats( std::ostream& os ) const {
+      std::lock_guard< std::mutex > lock( mMutex );
+      os << "Entries " << mEntries.size( ) << " of " << mCapacity << "." << std::endl;
+      os << "Lookups " << mLookups << ", hits " << mHits;
+      if( mLookups > 0 ) {
+        os << " (" << ( 100.0 * mHits ) / mLookups << "%)";
+      }
+      os << "." << std::endl;
+      os << "Stored " << mStores << ", loaded " << mLoaded << ", evicted " << mEvictions << "." << std::endl;
+      if( mFile.is_open( ) ) {
+        os << "File " << mFilename << "." << std::endl;
+      }
+    }
+
+    /*
+     *
+     * SolutionCache class
+     *
+     **************************************************************/
+
+  }
+}
@@ -0,0 +1,119 @@
+#ifndef _CGLRUBIKSSOLUTIONCACHE_H_
+#define _CGLRUBIKSSOLUTIONCACHE_H_
+
+#include "cglRubiksCube.h"
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*
+     * The whole cube rotations (generated by x and y) that map a set of
+     * named moves onto itself.  Rotating a cube, its goals and its
+     * moves together, and consistently relabelling the colors, does not
+     * change which move sequences solve it.  So problems that differ
+     * only that way share a canonical form, and a solution of one can
+     * be translated to the others.
+     */
+    class CubeSymmetry {
+    public:
+      /* with allow_symmetry false, only the identity is used and colors are
+       * kept, for moves that depend on colors (plan actions)
+       */
+      CubeSymmetry( const std::map< std::string, Move >& moves, const bool allow_symmetry );
+
+      unsigned int getNumRotations( ) const;
+
+      /* the smallest relabelled form of goals and cube over all rotations,
+       * and the rotation that produced it
+       */
+      std::string canonicalize( const std::vector< Cube >& goals, const Cube& cube, unsigned int& rotation ) const;
+
+      /* translate a move name into, or back out of, the frame of rotation */
+      const std::string& toCanonical( const unsigned int rotation, const std::string& move_name ) const;
+      const std::string& fromCanonical( const unsigned int rotation, const std::string& move_name ) const;
+
+      /* the name of the move with this transform, or "" */
+      std::string findMoveName( const Move& move ) const;
+
+      /* hash of the names, transforms and costs of the moves */
+      std::string getMovesHash( ) const;
+
+      /* the FNV-1a hash of text, as 16 hex digits */
+      static std::string hashText( const std::string& text );
+
+    protected:
+      std::string relabel( const std::vector< Cube >& goals, const Cube& cube, const Move& rotation ) const;
+
+      bool                mAllowSymmetry;
+      std::vector< Move > mRotations;
+      std::vector< std::map< std::string, std::string > > mToCanonical;
+      std::vector< std::map< std::string, std::string > > mFromCanonical;
+      std::map< std::vector< int >, std::string > mNamesByTransform;
+      std::string         mMovesHash;
+
+    private:
+    };
+
+    /*
+     * Solutions keyed by canonical problem.  The moves are stored by name,
+     * in the canonical frame.  The most recently used entries are kept in
+     * memory, up to the capacity.  An optional file keeps every stored
+     * entry, one per line, and is loaded when it is opened.
+     * All methods may be called from several threads.
+     */
+    class SolutionCache {
+    public:
+      struct Entry {
+        double                     cost;
+        std::vector< std::string > moves;
+      };
+
+      SolutionCache( );
+      ~SolutionCache( );
+      void clear( );
+      void setCapacity( const size_t capacity );
+      /* load the entries in filename, and append new entries to it */
+      bool openFile( const std::string& filename );
+
+      bool lookup( const std::string& key, Entry& entry );
+      void store( const std::string& key, const Entry& entry );
+      /* count a hit that could not be used, it is a miss */
+      void rejectHit( );
+
+      void displayStats( std::ostream& os ) const;
+
+    protected:
+      typedef std::list< std::pair< std::string, Entry > > EntryList;
+      void insert( const std::string& key, const Entry& entry );
+
+      mutable std::mutex mMutex;
+      EntryList          mEntries; // most recently used first
+      std::unordered_map< std::string, EntryList::iterator > mIndex;
+      size_t             mCapacity;
+      std::string        mFilename;
+      std::ofstream      mFile;
+      size_t             mLookups;
+      size_t             mHits;
+      size_t             mStores;
+      size_t             mLoaded;
+      size_t             mEvictions;
+
+    private:
+    };
+
+  }
+}
+
+
+#endif /* _CGLRUBIKSSOLUTIONCACHE_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
@@ -0,0 +1,60 @@
+#include "cglRubiksStageSet.h"
+
+namespace cgl {
+  namespace rubiks {
+
+    StageSet::StageSet( ) {
+      clearStages( );
+    }
+
+    void StageSet::clearStages( ) {
+      mStages.clear( );
+      mMemo.clear( );
+    }
+
+    void StageSet::setStages( const std::vector< Cube >& stages ) {
+      mStages = stages;
+      mMemo.clear( );
+      mMemo.resize( mStages.size( ) );
+    }
+
+    const std::vector< Cube >& StageSet::getStages( ) const {
+      return mStages;
+    }
+
+    unsigned int StageSet::size( ) const {
+      return mStages.size( );
+    }
+
+    std::string StageSet::memoKey( const unsigned int stage, const std::string& method, const Cube& cube ) const {
+      const std::vector< Facelet >& goal = mStages[ stage ].getFacelets( );
+      const std::vector< Facelet >& facelets = cube.getFacelets( );
+      std::string key = method + " ";
+      unsigned int i;
+      for( i = 0; i < goal.size( ); i++ ) {
+        if( goal[ i ] != '*' ) {
+          key += facelets[ i ];
+        }
+      }
+      return key;
+    }
+
+    bool StageSet::findSolution( const unsigned int stage, const std::string& method, const Cube& cube, std::vector< Move >& moves ) const {
+      auto it = mMemo[ stage ].find( memoKey( stage, method, cube ) );
+      if( it == mMemo[ stage ].end( ) ) {
+        return false;
+      }
+      moves = it->second;
+      return true;
+    }
+
+    void StageSet::storeSolution( const unsigned int stage, const std::string& method, const Cube& cube, const std::vector< Move >& moves ) {
+      mMemo[ stage ][ memoKey( stage, method, cube ) ] = moves;
+    }
+
+    size_t StageSet::getMemoSize( const unsigned int stage ) const {
+      return mMemo[ stage ].size( );
+    }
+
+  }
+}
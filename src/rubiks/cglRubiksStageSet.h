@@ -0,0 +1,52 @@
+#ifndef _CGLRUBIKSSTAGESET_H_
+#define _CGLRUBIKSSTAGESET_H_
+
+#include "cglRubiksCube.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*
+     * Ordered intermediate goals for hierarchical solving.  Each stage
+     * is a wildcard cube, solved in order from the current cube.
+     *
+     * Each stage remembers the moves that solved it, keyed by the
+     * solving method (search or plan, with the moves or plan actions
+     * they may use) and the cube's facelets at the positions the stage
+     * goal constrains.
+     * Different cubes can share a key, so a remembered solution must
+     * be checked against the goal before it is used.
+     */
+    class StageSet {
+    public:
+      StageSet( );
+      void clearStages( );
+      void setStages( const std::vector< Cube >& stages );
+      const std::vector< Cube >& getStages( ) const;
+      unsigned int size( ) const;
+
+      std::string memoKey( const unsigned int stage, const std::string& method, const Cube& cube ) const;
+      /* returns true and fills moves if a solution is remembered for cube's key */
+      bool findSolution( const unsigned int stage, const std::string& method, const Cube& cube, std::vector< Move >& moves ) const;
+      void storeSolution( const unsigned int stage, const std::string& method, const Cube& cube, const std::vector< Move >& moves );
+      size_t getMemoSize( const unsigned int stage ) const;
+
+    protected:
+      std::vector< Cube > mStages;
+      std::vector< std::map< std::string, std::vector< Move > > > mMemo;
+
+    private:
+
+    };
+
+  }
+}
+
+
+#endif /* _CGLRUBIKSSTAGESET_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
@@ -28,6 +28,19 @@ namespace cgl {
       return mCube < state->mCube;
     }
 
+    size_t State::MemoryBytes( ) const {
+      return ai::Search::HeapBlockBytes( sizeof( State ) ) + ai::Search::VectorHeapBytes( mCube.getFacelets( ) );
+    }
+
+    /* FNV-1a of the facelets */
+    std::uint64_t State::Fingerprint( ) const {
+      std::uint64_t hash = 14695981039346656037ULL;
+      for( const Facelet facelet : mCube.getFacelets( ) ) {
+        hash = ( hash ^ static_cast< unsigned char >( facelet ) ) * 1099511628211ULL;
+      }
+      return hash;
+    }
+
     bool State::operator==( const State& rhs ) const {
       return this->IsEqual( &rhs );
     }
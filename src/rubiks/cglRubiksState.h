@@ -15,6 +15,8 @@ namespace cgl {
       virtual void Display( ) const;
       virtual bool IsEqual(const ai::Search::State * const state_in) const;
       virtual bool IsLessThan(const ai::Search::State * const state_in) const;
+      virtual size_t MemoryBytes( ) const;
+      virtual std::uint64_t Fingerprint( ) const;
 
       bool operator==( const State& rhs ) const;
       State& operator=( const State& rhs);
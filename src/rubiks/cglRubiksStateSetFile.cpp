@@ -0,0 +1,443 @@
+#include "cglRubiksStateSetFile.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cgl {
+  namespace rubiks {
+
+    /**************************************************************
+     *
+     * StateSetFormat class
+     *
+     */
+
+    const char *StateSetFormat::MAGIC = "CGLSTATE";
+
+    StateSetFormat::StateSetFormat( )
+      : mBitsPerFacelet( 0 ), mPackedSize( 0 ) {
+      setColors( "" );
+    }
+
+    void StateSetFormat::setColors( const Cube& source ) {
+      const std::vector< Facelet >& facelets = source.getFacelets( );
+      std::string colors( facelets.begin( ), facelets.end( ) );
+      std::sort( colors.begin( ), colors.end( ) );
+      colors.erase( std::unique( colors.begin( ), colors.end( ) ), colors.end( ) );
+      setColors( colors );
+    }
+
+    void StateSetFormat::setColors( const std::string& colors ) {
+      mColors = colors;
+      std::fill( mCodes, mCodes + 256, -1 );
+      unsigned int i;
+      for( i = 0; i < mColors.size( ); i++ ) {
+        mCodes[ static_cast< unsigned char >( mColors[ i ] ) ] = i;
+      }
+      mBitsPerFacelet = 1;
+      while( ( 1u << mBitsPerFacelet ) < mColors.size( ) ) {
+        mBitsPerFacelet++;
+      }
+      mPackedSize = ( NUM_POSITIONS_TOTAL * mBitsPerFacelet + 7 ) / 8;
+    }
+
+    const std::string& StateSetFormat::getColors( ) const {
+      return mColors;
+    }
+
+    unsigned int StateSetFormat::getBitsPerFacelet( ) const {
+      return mBitsPerFacelet;
+    }
+
+    unsigned int StateSetFormat::getPackedSize( ) const {
+      return mPackedSize;
+    }
+
+    bool StateSetFormat::pack( const std::string& facelets, std::string& packed ) const {
+      packed.assign( mPackedSize, '\0' );
+      unsigned int bit = 0;
+      unsigned int i;
+      for( i = 0; i < facelets.size( ); i++ ) {
+        int code = mCodes[ static_cast< unsigned char >( facelets[ i ] ) ];
+        if( code < 0 ) {
+          return false;
+        }
+        unsigned int b;
+        for( b = mBitsPerFacelet; b > 0; b--, bit++ ) {
+          if( code & ( 1 << ( b - 1 ) ) ) {
+            packed[ bit / 8 ] |= static_cast< char >( 0x80 >> ( bit % 8 ) );
+          }
+        }
+      }
+      return true;
+    }
+
+    void StateSetFormat::unpack( const std::string& packed, std::string& facelets ) const {
+      facelets.resize( NUM_POSITIONS_TOTAL );
+      unsigned int bit = 0;
+      unsigned int i;
+      for( i = 0; i < facelets.size( ); i++ ) {
+        unsigned int code = 0;
+        unsigned int b;
+        for( b = 0; b < mBitsPerFacelet; b++, bit++ ) {
+          code = ( code << 1 ) | ( ( static_cast< unsigned char >( packed[ bit / 8 ] ) >> ( 7 - bit % 8 ) ) & 1 );
+        }
+        facelets[ i ] = code < mColors.size( ) ? mColors[ code ] : '*';
+      }
+    }
+
+    /*
+     *
+     * StateSetFormat class
+     *
+     **************************************************************/
+
+    /**************************************************************
+     *
+     * StateSetWriter class
+     *
+     */
+
+    StateSetWriter::StateSetWriter( ) {
+      // empty
+    }
+
+    StateSetWriter::~StateSetWriter( ) {
+      if( mFile.is_open( ) ) {
+        close( );
+      }
+    }
+
+    bool StateSetWriter::open( const std::string& filename, const Cube& source, const std::map< std::string, Move >& moves ) {
+      mFile.open( filename, std::ios::binary | std::ios::trunc );
+      if( !mFile ) {
+        return false;
+      }
+      mFormat.setColors( source );
+      mFile.write( StateSetFormat::MAGIC, std::strlen( StateSetFormat::MAGIC ) );
+      writeNumber( StateSetFormat::VERSION );
+
+      const std::string& colors = mFormat.getColors( );
+      writeNumber( colors.size( ) );
+      mFile.write( colors.data( ), colors.size( ) );
+      const std::vector< Facelet >& facelets = source.getFacelets( );
+      mFile.write( facelets.data( ), facelets.size( ) );
+
+      writeNumber( moves.size( ) );
+      for( auto it = moves.begin( ); it != moves.end( ); it++ ) {
+        writeNumber( it->first.size( ) );
+        mFile.write( it->first.data( ), it->first.size( ) );
+        const std::vector< int >& transform = it->second.getTransform( );
+        for( auto t = transform.begin( ); t != transform.end( ); t++ ) {
+          writeNumber( *t );
+        }
+      }
+      return static_cast< bool >( mFile );
+    }
+
+    void StateSetWriter::beginLayer( const int depth, const size_t count ) {
+      writeNumber( depth );
+      writeNumber( count );
+      mPrevious.clear( );
+    }
+
+    bool StateSetWriter::writeState( const std::string& facelets, const std::uint64_t paths ) {
+      if( !mFormat.pack( facelets, mPacked ) ) {
+        return false;
+      }
+      size_t shared = 0;
+      while( shared < mPrevious.size( ) && mPrevious[ shared ] == mPacked[ shared ] ) {
+        shared++;
+      }
+      writeNumber( shared );
+      mFile.write( mPacked.data( ) + shared, mPacked.size( ) - shared );
+      writeNumber( paths );
+      mPrevious.swap( mPacked );
+      return true;
+    }
+
+    bool StateSetWriter::close( ) {
+      beginLayer( 0, 0 );
+      mFile.close( );
+      return !mFile.fail( );
+    }
+
+    void StateSetWriter::writeNumber( std::uint64_t value ) {
+      char bytes[ 10 ];
+      int n = 0;
+      do {
+        bytes[ n ] = static_cast< char >( value & 0x7f );
+        value >>= 7;
+        if( value != 0 ) {
+          bytes[ n ] |= static_cast< char >( 0x80 );
+        }
+        n++;
+      } while( value != 0 );
+      mFile.write( bytes, n );
+    }
+
+    /*
+     *
+     * StateSetWriter class
+     *
+     **************************************************************/
+
+    /**************************************************************
+     *
+     * StateSetReader class
+     *
+     */
+
+    StateSetReader::StateSetReader( )
+      : mData( 0 ), mSize( 0 ), mPosition( 0 ), mDepth( 0 ), mRemaining( 0 ), mComplete( false ) {
+      // empty
+    }
+
+    StateSetReader::~StateSetReader( ) {
+      close( );
+    }
+
+    bool StateSetReader::open( const std::string& filename ) {
+      close( );
+      int fd = ::open( filename.c_str( ), O_RDONLY );
+      if( fd < 0 ) {
+        return fail( "Unable to open " + filename + "." );
+      }
+      struct stat st;
+      if( fstat( fd, &st ) != 0 || st.st_size == 0 ) {
+        ::close( fd );
+        return fail( "Unable to read " + filename + "." );
+      }
+      void *data = mmap( 0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      ::close( fd );
+      if( data == MAP_FAILED ) {
+        return fail( "Unable to map " + filename + "." );
+      }
+      mData = static_cast< const unsigned char * >( data );
+      mSize = st.st_size;
+      madvise( data, mSize, MADV_SEQUENTIAL );
+
+      std::string bytes;
+      std::uint64_t value;
+      if( !readBytes( std::strlen( StateSetFormat::MAGIC ), bytes ) || bytes != StateSetFormat::MAGIC ) {
+        return fail( filename + " is not a state set file." );
+      }
+      if( !readNumber( value ) || value != StateSetFormat::VERSION ) {
+        return fail( filename + " has an unknown state set version." );
+      }
+      if( !readNumber( value ) || value == 0 || value > 256 || !readBytes( value, bytes ) ) {
+        return fail( filename + " has bad colors." );
+      }
+      mFormat.setColors( bytes );
+      if( !readBytes( NUM_POSITIONS_TOTAL, bytes ) ) {
+        return fail( filename + " has a bad source cube." );
+      }
+      mSource.assignFromString( bytes );
+
+      std::uint64_t num_moves;
+      if( !readNumber( num_moves ) ) {
+        return fail( filename + " has bad moves." );
+      }
+      std::uint64_t i;
+      for( i = 0; i < num_moves; i++ ) {
+        std::string name;
+        if( !readNumber( value ) || !readBytes( value, name ) ) {
+          return fail( filename + " has bad moves." );
+        }
+        std::vector< int > transform( NUM_POSITIONS_TOTAL );
+        for( auto t = transform.begin( ); t != transform.end( ); t++ ) {
+          if( !readNumber( value ) || value >= NUM_POSITIONS_TOTAL ) {
+            return fail( filename + " has bad moves." );
+          }
+          *t = value;
+        }
+        mMoveNames.push_back( name );
+        mMoveTransforms.push_back( transform );
+      }
+      return true;
+    }
+
+    void StateSetReader::close( ) {
+      if( mData ) {
+        munmap( const_cast< unsigned char * >( mData ), mSize );
+      }
+      mData = 0;
+      mSize = 0;
+      mPosition = 0;
+      mFormat.setColors( "" );
+      mSource.assignSolved( );
+      mMoveNames.clear( );
+      mMoveTransforms.clear( );
+      mDepth = 0;
+      mRemaining = 0;
+      mPrevious.clear( );
+      mComplete = false;
+      mError.clear( );
+    }
+
+    const Cube& StateSetReader::getSourceCube( ) const {
+      return mSource;
+    }
+
+    const std::vector< std::string >& StateSetReader::getMoveNames( ) const {
+      return mMoveNames;
+    }
+
+    const std::vector< std::vector< int > >& StateSetReader::getMoveTransforms( ) const {
+      return mMoveTransforms;
+    }
+
+    const std::string& StateSetReader::getError( ) const {
+      return mError;
+    }
+
+    bool StateSetReader::next( Record& record ) {
+      if( !mData || mComplete || !mError.empty( ) ) {
+        return false;
+      }
+      std::uint64_t value;
+      while( mRemaining == 0 ) {
+        std::uint64_t depth;
+        if( !readNumber( depth ) || !readNumber( mRemaining ) ) {
+          return fail( "The state set file ends early." );
+        }
+        if( mRemaining == 0 ) {
+          mComplete = true;
+          return false;
+        }
+        mDepth = depth;
+        mPrevious.clear( );
+      }
+      std::string rest;
+      if( !readNumber( value ) || value > mPrevious.size( ) ||
+          !readBytes( mFormat.getPackedSize( ) - value, rest ) ) {
+        return fail( "The state set file has a bad state." );
+      }
+      mPrevious.resize( value );
+      mPrevious += rest;
+      if( !readNumber( record.paths ) ) {
+        return fail( "The state set file ends early." );
+      }
+      mFormat.unpack( mPrevious, record.facelets );
+      record.depth = mDepth;
+      mRemaining--;
+      return true;
+    }
+
+    bool StateSetReader::isComplete( ) const {
+      return mComplete;
+    }
+
+    bool StateSetReader::readNumber( std::uint64_t& value ) {
+      value = 0;
+      int shift;
+      for( shift = 0; shift < 64 && mPosition < mSize; shift += 7 ) {
+        unsigned char byte = mData[ mPosition++ ];
+        value |= static_cast< std::uint64_t >( byte & 0x7f ) << shift;
+        if( ( byte & 0x80 ) == 0 ) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    bool StateSetReader::readBytes( const size_t count, std::string& bytes ) {
+      if( count > mSize - mPosition ) {
+        return false;
+      }
+      bytes.assign( reinterpret_cast< const char * >( mData + mPosition ), count );
+      mPosition += count;
+      return true;
+    }
+
+    bool StateSetReader::fail( const std::string& error ) {
+      mError = error;
+      return false;
+    }
+
+    /*
+     *
+     * StateSetReader class
+     *
+     **************************************************************/
+
+    /**************************************************************
+     *
+     * StateTable class
+     *
+     */
+
+    StateTable::StateTable( )
+      : mMaxDepth( -1 ) {
+      // empty
+    }
+
+    void StateTable::clear( ) {
+      mStates.clear( );
+      mMaxDepth = -1;
+      mFilename.clear( );
+    }
+
+    bool StateTable::load( const std::string& filename, std::string& error ) {
+      clear( );
+      StateSetReader reader;
+      if( !reader.open( filename ) ) {
+        error = reader.getError( );
+        return false;
+      }
+      mFormat.setColors( reader.getSourceCube( ) );
+      StateSetReader::Record record;
+      std::string packed;
+      while( reader.next( record ) ) {
+        mFormat.pack( record.facelets, packed );
+        mStates[ packed ] = std::make_pair( record.depth, record.paths );
+        mMaxDepth = std::max( mMaxDepth, record.depth );
+      }
+      if( !reader.isComplete( ) ) {
+        error = reader.getError( );
+        clear( );
+        return false;
+      }
+      mFilename = filename;
+      return true;
+    }
+
+    bool StateTable::lookup( const Cube& cube, int& depth, std::uint64_t& paths ) const {
+      const std::vector< Facelet >& facelets = cube.getFacelets( );
+      std::string packed;
+      if( !mFormat.pack( std::string( facelets.begin( ), facelets.end( ) ), packed ) ) {
+        return false;
+      }
+      auto it = mStates.find( packed );
+      if( it == mStates.end( ) ) {
+        return false;
+      }
+      depth = it->second.first;
+      paths = it->second.second;
+      return true;
+    }
+
+    size_t StateTable::size( ) const {
+      return mStates.size( );
+    }
+
+    int StateTable::getMaxDepth( ) const {
+      return mMaxDepth;
+    }
+
+    const std::string& StateTable::getFilename( ) const {
+      return mFilename;
+    }
+
+    /*
+     *
+     * StateTable class
+     *
+     **************************************************************/
+
+  }
+}
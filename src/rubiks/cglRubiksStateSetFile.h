@@ -0,0 +1,166 @@
+#ifndef _CGLRUBIKSSTATESETFILE_H_
+#define _CGLRUBIKSSTATESETFILE_H_
+
+#include "cglRubiksCube.h"
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*
+     * Binary files of cube states, as written by `generate ... binary`.
+     *
+     * The header holds the source cube and the moves (name and
+     * transform) used to reach the states.  The states follow in
+     * layers of increasing depth, each state with the number of
+     * shortest paths from the source cube that reach it.
+     *
+     * Each state is bit-packed, with each facelet a code into the
+     * sorted colors of the source cube (3 bits for 6 colors, 21 bytes
+     * per cube).  The codes are packed most significant bit first, so
+     * packed states sort the same as their facelet strings.  Within a
+     * layer, states are sorted and each is stored as the number of
+     * bytes it shares with the previous state, then the rest of its
+     * bytes.  Numbers are unsigned LEB128 varints.
+     *
+     *   "CGLSTATE" version
+     *   num_colors colors source_cube_facelets
+     *   num_moves { name_length name transform[ NUM_POSITIONS_TOTAL ] }
+     *   { depth count { shared_bytes rest_bytes paths } }
+     *   depth 0    (a layer with count 0 ends the file)
+     */
+    class StateSetFormat {
+    public:
+      StateSetFormat( );
+      /* sets the colors to the distinct facelets of source */
+      void setColors( const Cube& source );
+      void setColors( const std::string& colors );
+      const std::string& getColors( ) const;
+
+      unsigned int getBitsPerFacelet( ) const;
+      unsigned int getPackedSize( ) const;
+
+      /* false if a facelet is not one of the colors */
+      bool pack( const std::string& facelets, std::string& packed ) const;
+      void unpack( const std::string& packed, std::string& facelets ) const;
+
+      static const char *MAGIC;
+      static const unsigned int VERSION = 1;
+
+    protected:
+      std::string  mColors;
+      int          mCodes[ 256 ];
+      unsigned int mBitsPerFacelet;
+      unsigned int mPackedSize;
+
+    private:
+    };
+
+    class StateSetWriter {
+    public:
+      StateSetWriter( );
+      ~StateSetWriter( );
+
+      bool open( const std::string& filename, const Cube& source, const std::map< std::string, Move >& moves );
+      /* count states must follow, in increasing order */
+      void beginLayer( const int depth, const size_t count );
+      /* false if facelets has a color the source cube does not */
+      bool writeState( const std::string& facelets, const std::uint64_t paths );
+      /* writes the end of the file, false if any write failed */
+      bool close( );
+
+    protected:
+      void writeNumber( std::uint64_t value );
+
+      std::ofstream  mFile;
+      StateSetFormat mFormat;
+      std::string    mPrevious;
+      std::string    mPacked;
+
+    private:
+    };
+
+    class StateSetReader {
+    public:
+      struct Record {
+        std::string   facelets;
+        int           depth;
+        std::uint64_t paths;
+      };
+
+      StateSetReader( );
+      ~StateSetReader( );
+
+      /* maps the file into memory and reads the header */
+      bool open( const std::string& filename );
+      void close( );
+
+      const Cube& getSourceCube( ) const;
+      const std::vector< std::string >& getMoveNames( ) const;
+      const std::vector< std::vector< int > >& getMoveTransforms( ) const;
+      const std::string& getError( ) const;
+
+      /* false at the end of the file, or if it is damaged (see getError) */
+      bool next( Record& record );
+      /* true once the end of the file has been read */
+      bool isComplete( ) const;
+
+    protected:
+      bool readNumber( std::uint64_t& value );
+      bool readBytes( const size_t count, std::string& bytes );
+      bool fail( const std::string& error );
+
+      const unsigned char *mData;
+      size_t         mSize;
+      size_t         mPosition;
+      StateSetFormat mFormat;
+      Cube           mSource;
+      std::vector< std::string > mMoveNames;
+      std::vector< std::vector< int > > mMoveTransforms;
+      int            mDepth;
+      std::uint64_t  mRemaining;
+      std::string    mPrevious;
+      bool           mComplete;
+      std::string    mError;
+
+    private:
+    };
+
+    /*
+     * The depth and path count of each state in a state set file,
+     * kept bit-packed.
+     */
+    class StateTable {
+    public:
+      StateTable( );
+      void clear( );
+      /* reads every state in filename, false with the error if it fails */
+      bool load( const std::string& filename, std::string& error );
+
+      bool lookup( const Cube& cube, int& depth, std::uint64_t& paths ) const;
+      size_t size( ) const;
+      int getMaxDepth( ) const;
+      const std::string& getFilename( ) const;
+
+    protected:
+      StateSetFormat mFormat;
+      std::unordered_map< std::string, std::pair< int, std::uint64_t > > mStates;
+      int            mMaxDepth;
+      std::string    mFilename;
+
+    private:
+    };
+
+  }
+}
+
+
+#endif /* _CGLRUBIKSSTATESETFILE_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
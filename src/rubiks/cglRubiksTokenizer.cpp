@@ -0,0 +1,75 @@
+#include "cglRubiksTokenizer.h"
+
+namespace cgl {
+  namespace rubiks {
+
+    /* the characters stream extraction skips in the C locale */
+    static bool is_space( const char c ) {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    bool Tokenizer::readLine( std::istream& is ) {
+      mLine.clear( );
+      mSpans.clear( );
+      mTokens.clear( );
+
+      bool done = false;
+      while( !done ) {
+        if( !std::getline( is, mPart ) ) {
+          return false;
+        }
+        size_t i = mLine.size( );
+        mLine += mPart;
+        mLine += ' ';
+        while( i < mLine.size( ) ) {
+          while( i < mLine.size( ) && is_space( mLine[ i ] ) ) {
+            i++;
+          }
+          size_t start = i;
+          while( i < mLine.size( ) && !is_space( mLine[ i ] ) ) {
+            i++;
+          }
+          if( i > start ) {
+            mSpans.push_back( std::make_pair( start, i - start ) );
+          }
+        }
+
+        if( mSpans.size( ) > 0 && mSpans.back( ).second == 1 && mLine[ mSpans.back( ).first ] == '\\' ) {
+          mSpans.pop_back( );
+          done = false;
+        } else {
+          done = true;
+        }
+      }
+
+      for( auto it = mSpans.begin( ); it != mSpans.end( ); it++ ) {
+        mTokens.push_back( std::string_view( mLine.data( ) + it->first, it->second ) );
+      }
+      return true;
+    }
+
+    const std::vector< std::string_view >& Tokenizer::getTokens( ) const {
+      return mTokens;
+    }
+
+    void Tokenizer::assignWords( std::vector< std::string >& words ) {
+      while( words.size( ) > mTokens.size( ) ) {
+        mSpare.push_back( std::move( words.back( ) ) );
+        words.pop_back( );
+      }
+      while( words.size( ) < mTokens.size( ) ) {
+        if( mSpare.empty( ) ) {
+          words.emplace_back( );
+        } else {
+          words.push_back( std::move( mSpare.back( ) ) );
+          mSpare.pop_back( );
+        }
+      }
+      size_t i;
+      for( i = 0; i < mTokens.size( ); i++ ) {
+        words[ i ].assign( mTokens[ i ] );
+      }
+    }
+
+  }
+}
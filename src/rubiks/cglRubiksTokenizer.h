@@ -0,0 +1,71 @@
+#ifndef _CGLRUBIKSTOKENIZER_H_
+#define _CGLRUBIKSTOKENIZER_H_
+
+#include <charconv>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*
+     * Splits command lines into whitespace separated words.
+     *
+     * The words are views into one line buffer that is reused, so after
+     * the first few lines reading a line allocates nothing.  A line
+     * whose last word is \ continues on the next line.
+     */
+    class Tokenizer {
+    public:
+      /* Reads the next line, with its continuations, from is.  Returns
+       * false at end of file or on an error, like std::getline.
+       */
+      bool readLine( std::istream& is );
+
+      /* Views into the line, valid until the next readLine. */
+      const std::vector< std::string_view >& getTokens( ) const;
+
+      /* Copies the tokens into words, reusing the strings words and
+       * earlier calls left behind, so their storage is not reallocated.
+       */
+      void assignWords( std::vector< std::string >& words );
+
+    protected:
+      std::string                       mLine;   // the physical lines, each followed by a space
+      std::string                       mPart;   // the physical line being read
+      std::vector< std::string_view >   mTokens;
+      std::vector< std::pair< size_t, size_t > > mSpans; // offset and length, as mLine may move
+      std::vector< std::string >        mSpare;  // strings words no longer needs
+
+    private:
+    };
+
+    /* Parses the number at the start of text, ignoring a leading + and
+     * anything after the number, as stream extraction did.  Returns
+     * false, leaving value unchanged, if text does not start with one.
+     */
+    template < class T >
+    bool parse_number( const std::string_view text, T& value ) {
+      const char *first = text.data( );
+      const char *last = first + text.size( );
+      if( first != last && *first == '+' ) {
+        first++;
+      }
+      T number;
+      std::from_chars_result result = std::from_chars( first, last, number );
+      if( result.ec != std::errc( ) ) {
+        return false;
+      }
+      value = number;
+      return true;
+    }
+
+  }
+}
+
+#endif /* _CGLRUBIKSTOKENIZER_H_ */
+/* Local Variables: */
+/* mode:c++         */
+/* End:             */
@@ -0,0 +1,182 @@
+#include "ai_search.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace cgl {
+  namespace rubiks {
+
+    /*********************************************
+     * Summary
+     */
+
+    /* histogram buckets are [ bucket * width, ( bucket + 1 ) * width ) */
+    typedef std::map< long, std::uint64_t > Histogram;
+
+    struct DepthSummary {
+      DepthSummary( )
+        : expansions( 0 ), children( 0 ), duplicates( 0 ), h_sum( 0.0 ), f_sum( 0.0 ) {
+      }
+      std::uint64_t expansions;
+      std::uint64_t children;
+      std::uint64_t duplicates;
+      double        h_sum;
+      double        f_sum;
+      Histogram     h;
+      Histogram     f;
+    };
+
+    struct TraceSummary {
+      TraceSummary( )
+        : records( 0 ), children( 0 ), duplicates( 0 ), reexpansions( 0 ) {
+      }
+      std::set< std::uint32_t >            searches;
+      std::uint64_t                        records;
+      std::uint64_t                        children;
+      std::uint64_t                        duplicates;
+      std::uint64_t                        reexpansions; // fingerprint already expanded in its search
+      std::map< std::uint32_t, DepthSummary > depths;
+    };
+
+    static long bucket_of( const double value, const double width ) {
+      return static_cast< long >( std::floor( value / width ) );
+    }
+
+    /* concurrent searches, e.g. from batch, interleave their records */
+    typedef std::unordered_map< std::uint32_t, std::unordered_set< std::uint64_t > > ExpandedStates;
+
+    static void add_record( TraceSummary& summary, const ai::Search::TraceRecord& record, const double width, ExpandedStates& expanded ) {
+      summary.searches.insert( record.search );
+      summary.records++;
+      summary.children += record.children;
+      summary.duplicates += record.duplicates;
+      if( !expanded[ record.search ].insert( record.fingerprint ).second ) {
+        summary.reexpansions++;
+      }
+
+      DepthSummary& depth = summary.depths[ record.depth ];
+      double f = record.g + record.h;
+      depth.expansions++;
+      depth.children += record.children;
+      depth.duplicates += record.duplicates;
+      depth.h_sum += record.h;
+      depth.f_sum += f;
+      depth.h[ bucket_of( record.h, width ) ]++;
+      depth.f[ bucket_of( f, width ) ]++;
+    }
+
+    /* duplicates as a fraction of the states generated */
+    static double duplicate_rate( const std::uint64_t children, const std::uint64_t duplicates ) {
+      return children + duplicates > 0 ? static_cast< double >( duplicates ) / ( children + duplicates ) : 0.0;
+    }
+
+    static void write_histogram( std::ostream& os, const std::string& name, const TraceSummary& summary, const double width ) {
+      os << std::endl << name << " histogram, bucket width " << width << ":" << std::endl;
+      for( auto it = summary.depths.begin( ); it != summary.depths.end( ); it++ ) {
+        const Histogram& histogram = ( name == "h" ) ? it->second.h : it->second.f;
+        os << std::setw( 6 ) << it->first << " ";
+        for( auto b = histogram.begin( ); b != histogram.end( ); b++ ) {
+          os << " " << b->first * width << ":" << b->second;
+        }
+        os << std::endl;
+      }
+    }
+
+    static void write_summary( std::ostream& os, const TraceSummary& summary, const double width ) {
+      os << "searches " << summary.searches.size( )
+         << " expansions " << summary.records
+         << " children " << summary.children
+         << " duplicates " << summary.duplicates
+         << " duplicate_rate " << std::fixed << std::setprecision( 4 ) << duplicate_rate( summary.children, summary.duplicates )
+         << " reexpansions " << summary.reexpansions << std::endl;
+
+      os << std::endl
+         << std::setw( 6 ) << "depth"
+         << std::setw( 12 ) << "expansions"
+         << std::setw( 10 ) << "branching"
+         << std::setw( 11 ) << "dup rate"
+         << std::setw( 10 ) << "mean h"
+         << std::setw( 10 ) << "mean f" << std::endl;
+      for( auto it = summary.depths.begin( ); it != summary.depths.end( ); it++ ) {
+        const DepthSummary& depth = it->second;
+        os << std::setw( 6 ) << it->first
+           << std::setw( 12 ) << depth.expansions
+           << std::setw( 10 ) << std::setprecision( 2 ) << static_cast< double >( depth.children ) / depth.expansions
+           << std::setw( 11 ) << std::setprecision( 4 ) << duplicate_rate( depth.children, depth.duplicates )
+           << std::setw( 10 ) << std::setprecision( 2 ) << depth.h_sum / depth.expansions
+           << std::setw( 10 ) << depth.f_sum / depth.expansions << std::endl;
+      }
+      os.unsetf( std::ios::floatfield );
+      os << std::setprecision( 6 );
+
+      write_histogram( os, "h", summary, width );
+      write_histogram( os, "f", summary, width );
+    }
+
+    /*
+     * Summary
+     *********************************************/
+
+    static int usage( const char *program ) {
+      std::cerr << "usage: " << program << " trace_file [--bucket-width w] [--search n]" << std::endl;
+      return 1;
+    }
+
+    static int trace_summary_main( int argc, char **argv ) {
+      std::string trace_file;
+      double width = 1.0;
+      bool one_search = false;
+      std::uint32_t search = 0;
+
+      int i;
+      for( i = 1; i < argc; i++ ) {
+        std::string arg = argv[ i ];
+        if( i + 1 < argc && arg == "--bucket-width" ) {
+          width = std::atof( argv[ ++i ] );
+          if( !( width > 0.0 ) ) {
+            return usage( argv[ 0 ] );
+          }
+        } else if( i + 1 < argc && arg == "--search" ) {
+          one_search = true;
+          search = static_cast< std::uint32_t >( std::strtoul( argv[ ++i ], 0, 10 ) );
+        } else if( trace_file == "" && arg[ 0 ] != '-' ) {
+          trace_file = arg;
+        } else {
+          return usage( argv[ 0 ] );
+        }
+      }
+      if( trace_file == "" ) {
+        return usage( argv[ 0 ] );
+      }
+
+      ai::Search::TraceFileReader reader;
+      if( !reader.Open( trace_file ) ) {
+        std::cerr << "Unable to read the trace '" << trace_file << "'." << std::endl;
+        return 1;
+      }
+      TraceSummary summary;
+      ExpandedStates expanded;
+      ai::Search::TraceRecord record;
+      while( reader.Next( record ) ) {
+        if( !one_search || record.search == search ) {
+          add_record( summary, record, width, expanded );
+        }
+      }
+      write_summary( std::cout, summary, width );
+      return 0;
+    }
+
+  }
+}
+
+int main( int argc, char **argv ) {
+  return cgl::rubiks::trace_summary_main( argc, argv );
+}